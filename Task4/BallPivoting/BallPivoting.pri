@@ -0,0 +1,15 @@
+# Include this file from a project that links against the BallPivoting static library.
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+CONFIG += thread
+
+BALLPIVOTING_OUT = $$shadowed($$PWD)
+win32:CONFIG(release, debug|release): BALLPIVOTING_OUT = $$BALLPIVOTING_OUT/release
+else:win32:CONFIG(debug, debug|release): BALLPIVOTING_OUT = $$BALLPIVOTING_OUT/debug
+
+LIBS += -L$$BALLPIVOTING_OUT -lBallPivoting
+
+win32-g++|unix: PRE_TARGETDEPS += $$BALLPIVOTING_OUT/libBallPivoting.a
+else:win32: PRE_TARGETDEPS += $$BALLPIVOTING_OUT/BallPivoting.lib
@@ -0,0 +1,34 @@
+TEMPLATE = lib
+TARGET = BallPivoting
+
+CONFIG += staticlib c++17 thread
+CONFIG -= qt
+
+SOURCES += \
+    BallPivotingAlgorithm.cpp \
+    BinaryPointCloud.cpp \
+    Grid.cpp \
+    MappedFile.cpp \
+    MeshWriter.cpp \
+    MortonOrder.cpp \
+    PivotKernel.cpp \
+    PivotKernelAvx2.cpp \
+    Ply.cpp \
+    PointCloudIO.cpp \
+    SyntheticCloud.cpp
+
+HEADERS += \
+    BallPivotingAlgorithm.h \
+    BinaryPointCloud.h \
+    DataStructures.h \
+    Grid.h \
+    MappedFile.h \
+    MeshWriter.h \
+    MortonOrder.h \
+    Parallel.h \
+    PivotKernel.h \
+    PivotKernelImpl.h \
+    Ply.h \
+    PointCloud.h \
+    PointCloudIO.h \
+    SyntheticCloud.h
@@ -0,0 +1,904 @@
+#include "BallPivotingAlgorithm.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <mutex>
+#include <numeric>
+#include <numbers>
+#include <stdexcept>
+#include <tuple>
+#include "Grid.h"
+#include "Parallel.h"
+#include "PivotKernel.h"
+
+enum class EdgeStatus {
+    active,
+    inner,
+    boundary
+};
+
+constexpr uint32_t NoEdge = std::numeric_limits<uint32_t>::max();
+
+//Serialises the calls of the arenas of concurrent workers into one upstream resource.
+//Arenas ask for large blocks, so the lock is taken rarely.
+class LockedResource : public std::pmr::memory_resource {
+public:
+    explicit LockedResource(std::pmr::memory_resource* upstream) : upstream_(upstream) { }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return upstream_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        upstream_->deallocate(pointer, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream_;
+    std::mutex mutex_;
+};
+
+//Half-edge a -> b of the face (a, b, opposite). Points are grid indices, prev, next and samePair index MeshState::edges.
+struct MeshEdge {
+    uint32_t a;
+    uint32_t b;
+    uint32_t opposite;
+    GeneratedPoint center;
+    uint32_t prev = NoEdge;
+    uint32_t next = NoEdge;
+    //Next edge created from a to b, non-manifold spots can have several
+    uint32_t samePair = NoEdge;
+    EdgeStatus status = EdgeStatus::active;
+};
+
+struct MeshFace : std::array<uint32_t, 3>{ };
+
+using Vector3f = GeneratedPoint;
+
+Triangle GetPositions(const Grid& grid, const MeshFace& f) {
+    return {grid.Position(f[0]), grid.Position(f[1]), grid.Position(f[2])};
+}
+
+std::optional<Vector3f> ComputeBallCenter(const Triangle& f, float radius) {
+    const Vector3f ac = f[2] - f[0];
+    const Vector3f ab = f[1] - f[0];
+    const Vector3f abXac = CrossProduct(ab, ac);
+    const Vector3f toCircumCircleCenter = (CrossProduct(abXac, ab) * DotProduct(ac, ac) + CrossProduct(ac, abXac) * DotProduct(ab, ab)) / (2 * DotProduct(abXac, abXac));
+    const Vector3f circumCircleCenter = f[0] + toCircumCircleCenter;
+
+    const auto heightSquared = radius * radius - DotProduct(toCircumCircleCenter, toCircumCircleCenter);
+    //Also rejects degenerate faces (duplicate or collinear points) whose center is NaN
+    if (!(heightSquared >= 0))
+        return {};
+    auto ballCenter = circumCircleCenter + f.GetNormUnitVector() * std::sqrt(heightSquared);
+    return ballCenter;
+}
+
+struct SeedResult {
+    MeshFace f;
+    Vector3f ballCenter;
+};
+
+//First seed of the cell in point order: three unused points whose empty ball faces along the cell's average normal.
+//Only reads the grid, so cells can be searched concurrently with separate neighborhood buffers.
+std::optional<SeedResult> FindSeedInCell(Grid& grid, size_t c, float radius, Neighborhood& neighborhood) {
+    const auto cell = grid.GetCell(c);
+    Vector3f normalSum{};
+    for (auto p = cell.first; p < cell.last; ++p)
+        normalSum = normalSum + grid.Normal(p);
+    const auto avgNormal = GetUnitVector(normalSum);
+
+    for (auto p1 = cell.first; p1 < cell.last; ++p1) {
+        if (grid.points_[p1].used) continue;
+
+        const auto p1Position = grid.Position(p1);
+        grid.SphericalNeighborhood(p1Position, radius, {p1}, neighborhood);
+        std::sort(begin(neighborhood), end(neighborhood), [&](uint32_t a, uint32_t b) {
+            return GetRegularLength(grid.Position(a) - p1Position) < GetRegularLength(grid.Position(b) - p1Position);
+        });
+
+        for (const auto p2 : neighborhood) {
+            if (grid.points_[p2].used) continue;
+            for (const auto p3 : neighborhood) {
+                if (p2 == p3 || grid.points_[p3].used) continue;
+                MeshFace f{{p1, p2, p3}};
+                const auto positions = GetPositions(grid, f);
+                if (DotProduct(positions.GetNormUnitVector(), avgNormal) < 0)
+                    continue;
+                const auto ballCenter = ComputeBallCenter(positions, radius);
+                if (ballCenter && grid.BallIsEmpty(ballCenter.value(), radius, {p1}))
+                    return SeedResult{f, ballCenter.value()};
+            }
+        }
+    }
+    return {};
+}
+
+struct SeedCandidate {
+    size_t cell;
+    SeedResult seed;
+};
+
+//Searches cells from firstCell on in parallel and returns the seeds of the first count cells that have one,
+//ordered by cell. Threads claim blocks of cells in ascending order and stop once count seeds are known in lower
+//cells, so the result is the one a serial scan would give. Seed points are not marked as used and seeds of different
+//cells may share points, check they are still unused before starting a front from a prefetched one.
+//Thread t of the search uses neighborhoods[t], which must be at least threads long.
+std::vector<SeedCandidate> FindSeedTriangles(Grid& grid, float radius, size_t firstCell, size_t count, size_t threads,
+                                             std::vector<Neighborhood>& neighborhoods, const CancellationToken& cancellation) {
+    const size_t cellCount = grid.CellCount();
+    if (count == 0 || firstCell >= cellCount)
+        return {};
+
+    const size_t blockSize = std::max<size_t>(16, (cellCount - firstCell) / (threads * 256));
+    std::atomic<size_t> nextCell{firstCell};
+    std::atomic<size_t> cutoff{cellCount};
+    std::mutex foundMutex;
+    std::vector<SeedCandidate> found;
+
+    ParallelForChunks(threads, threads, [&](size_t t, size_t, size_t) {
+        auto& neighborhood = neighborhoods[t];
+        while (!cancellation.IsCancelled()) {
+            const size_t blockBegin = nextCell.fetch_add(blockSize);
+            const size_t blockEnd = std::min(blockBegin + blockSize, cellCount);
+            if (blockBegin >= std::min(cutoff.load(), cellCount))
+                return;
+
+            for (size_t c = blockBegin; c < blockEnd && c < cutoff.load() && !cancellation.IsCancelled(); ++c) {
+                auto seed = FindSeedInCell(grid, c, radius, neighborhood);
+                if (!seed) continue;
+
+                std::lock_guard<std::mutex> lock(foundMutex);
+                const auto position = std::find_if(begin(found), end(found), [&](const SeedCandidate& candidate) {
+                    return candidate.cell > c;
+                });
+                found.insert(position, SeedCandidate{c, seed.value()});
+                if (found.size() > count)
+                    found.pop_back();
+                if (found.size() == count)
+                    cutoff = found.back().cell;
+            }
+        }
+    });
+
+    if (cancellation.IsCancelled())
+        return {};
+    return found;
+}
+
+//Open addressing map from a directed point pair to the first edge created from one point to the other,
+//later edges of the pair are chained through MeshEdge::samePair. Edges are never erased.
+class EdgeTable {
+public:
+    explicit EdgeTable(std::pmr::memory_resource* memory) : keys_(memory), edges_(memory) { }
+
+    uint32_t Find(uint32_t a, uint32_t b) const {
+        if (keys_.empty())
+            return NoEdge;
+        const auto key = Key(a, b);
+        for (auto slot = Slot(key);; slot = (slot + 1) & (keys_.size() - 1)) {
+            if (keys_[slot] == key) return edges_[slot];
+            if (keys_[slot] == EmptyKey) return NoEdge;
+        }
+    }
+
+    //Stores edge unless the pair has an edge already, returns that edge or NoEdge
+    uint32_t Insert(uint32_t a, uint32_t b, uint32_t edge) {
+        if ((size_ + 1) * 2 > keys_.size())
+            Rehash(std::max<size_t>(64, keys_.size() * 2));
+        const auto key = Key(a, b);
+        auto slot = Slot(key);
+        for (; keys_[slot] != EmptyKey; slot = (slot + 1) & (keys_.size() - 1))
+            if (keys_[slot] == key) return edges_[slot];
+        keys_[slot] = key;
+        edges_[slot] = edge;
+        size_++;
+        return NoEdge;
+    }
+
+private:
+    static constexpr uint64_t EmptyKey = std::numeric_limits<uint64_t>::max();
+
+    static uint64_t Key(uint32_t a, uint32_t b) { return static_cast<uint64_t>(a) << 32 | b; }
+
+    //Fibonacci hashing, the top bits of the product pick the slot
+    size_t Slot(uint64_t key) const { return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift_); }
+
+    void Rehash(size_t capacity) {
+        auto keys = std::move(keys_);
+        auto edges = std::move(edges_);
+        keys_.assign(capacity, EmptyKey);
+        edges_.assign(capacity, NoEdge);
+        shift_ = 64;
+        for (size_t c = capacity; c > 1; c >>= 1)
+            shift_--;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] == EmptyKey) continue;
+            auto slot = Slot(keys[i]);
+            while (keys_[slot] != EmptyKey)
+                slot = (slot + 1) & (capacity - 1);
+            keys_[slot] = keys[i];
+            edges_[slot] = edges[i];
+        }
+    }
+
+    std::pmr::vector<uint64_t> keys_;
+    std::pmr::vector<uint32_t> edges_;
+    size_t size_ = 0;
+    int shift_ = 64;
+};
+
+//Edges waiting for a pivot, handed out in the configured order. Edges that leave the front some other way stay
+//queued until they come up and are skipped then, or until they and the consumed FIFO entries outnumber the active
+//edges and get compacted away.
+//active counts the active edges of the mesh, including ones taken from the queue and not pivoted yet.
+class Front {
+public:
+    Front(FrontOrder order, std::pmr::memory_resource* memory) : order_(order), entries_(memory) { }
+
+    FrontOrder Order() const { return order_; }
+
+    //key orders the edges of the spatial order and is ignored by the others
+    void Push(uint32_t edge, uint64_t key) {
+        entries_.push_back({key, edge});
+        if (order_ == FrontOrder::spatial)
+            std::push_heap(entries_.begin(), entries_.end(), Later);
+    }
+
+    std::optional<uint32_t> Pop(const std::pmr::vector<MeshEdge>& edges) {
+        //The consumed FIFO prefix counts as well, or it would never be reclaimed while the queue stays short
+        if (entries_.size() > 2 * active + MinCompactedSize)
+            Compact(edges);
+
+        while (head_ < entries_.size()) {
+            uint32_t edge = NoEdge;
+            switch (order_) {
+            case FrontOrder::lifo:
+                edge = entries_.back().edge;
+                entries_.pop_back();
+                break;
+            case FrontOrder::fifo:
+                edge = entries_[head_++].edge;
+                break;
+            case FrontOrder::spatial:
+                std::pop_heap(entries_.begin(), entries_.end(), Later);
+                edge = entries_.back().edge;
+                entries_.pop_back();
+                break;
+            }
+            if (edges[edge].status == EdgeStatus::active)
+                return edge;
+        }
+        entries_.clear();
+        head_ = 0;
+        return {};
+    }
+
+    size_t active = 0;
+
+private:
+    //Queues shorter than this are not worth compacting
+    static constexpr size_t MinCompactedSize = 1024;
+
+    struct Entry {
+        uint64_t key;
+        uint32_t edge;
+    };
+
+    //Heap order of the spatial front, ties go to the older edge
+    static bool Later(const Entry& lhs, const Entry& rhs) {
+        return lhs.key != rhs.key ? lhs.key > rhs.key : lhs.edge > rhs.edge;
+    }
+
+    void Compact(const std::pmr::vector<MeshEdge>& edges) {
+        const auto inactive = [&](const Entry& entry) { return edges[entry.edge].status != EdgeStatus::active; };
+        entries_.erase(std::remove_if(entries_.begin() + head_, entries_.end(), inactive), entries_.end());
+        entries_.erase(entries_.begin(), entries_.begin() + head_);
+        head_ = 0;
+        if (order_ == FrontOrder::spatial)
+            std::make_heap(entries_.begin(), entries_.end(), Later);
+    }
+
+    FrontOrder order_;
+    std::pmr::vector<Entry> entries_;
+    //Start of the queue in the FIFO order
+    size_t head_ = 0;
+};
+
+//Mesh grown by one front: edge storage, the front over it and the triangles emitted so far.
+//Everything but the triangles, which are handed to the caller, comes from the memory resource of one thread.
+struct MeshState {
+    MeshState(FrontOrder order, std::pmr::memory_resource* memory) : edges(memory), pairs(memory), front(order, memory) { }
+
+    std::pmr::vector<MeshEdge> edges;
+    EdgeTable pairs;
+    Front front;
+    std::vector<IndexedTriangle> triangles;
+    size_t pointsUsed = 0;
+};
+
+std::optional<uint32_t> GetActiveEdge(MeshState& mesh) {
+    return mesh.front.Pop(mesh.edges);
+}
+
+//Queues an active edge, the spatial order sorts it by the cell of its midpoint
+void PushFront(uint32_t e, const Grid& grid, MeshState& mesh) {
+    uint64_t key = 0;
+    if (mesh.front.Order() == FrontOrder::spatial) {
+        const auto& edge = mesh.edges[e];
+        key = MortonCode(grid.GetCellIndex((grid.Position(edge.a) + grid.Position(edge.b)) / 2.0f));
+    }
+    mesh.front.Push(e, key);
+}
+
+//True when an inner edge joins p and q in either direction
+bool HasInnerEdge(const MeshState& mesh, uint32_t p, uint32_t q) {
+    for (const auto& [from, to] : {std::pair{p, q}, std::pair{q, p}})
+        for (auto e = mesh.pairs.Find(from, to); e != NoEdge; e = mesh.edges[e].samePair)
+            if (mesh.edges[e].status == EdgeStatus::inner)
+                return true;
+    return false;
+}
+
+struct PivotResult {
+    uint32_t p;
+    Vector3f center;
+};
+
+//Buffers of one pivoting thread, reused by every pivot of a run
+struct PivotScratch {
+    explicit PivotScratch(std::pmr::memory_resource* memory) : neighborhood(memory) { }
+
+    Neighborhood neighborhood;
+    PointCloud candidates;
+    PivotScores scores;
+};
+
+std::optional<PivotResult> BallPivot(const MeshEdge& e, Grid& grid, float radius, const MeshState& mesh, PivotScratch& scratch) {
+    const auto a = grid.Position(e.a);
+    const auto b = grid.Position(e.b);
+    const auto m = (a + b) / 2.0f;
+    const auto oldCenterVec = GetUnitVector(e.center - m);
+    auto& neighborhood = scratch.neighborhood;
+    grid.SphericalNeighborhood(m, radius, {e.a, e.b, e.opposite}, neighborhood);
+
+    scratch.candidates.resize(neighborhood.size());
+    for (size_t i = 0; i < neighborhood.size(); ++i)
+        scratch.candidates.Set(i, grid.cloud_[neighborhood[i]]);
+    EvaluatePivotCandidates(PivotFrame{a, b, m, oldCenterVec, radius}, scratch.candidates, scratch.scores);
+
+    const auto& scores = scratch.scores;
+    auto smallestAngle = std::numeric_limits<float>::infinity();
+    size_t smallest = 0;
+    for (size_t i = 0; i < neighborhood.size(); ++i) {
+        if (!(scores.angle[i] < smallestAngle))
+            continue;
+
+        const auto p = neighborhood[i];
+        if (HasInnerEdge(mesh, p, e.a) || HasInnerEdge(mesh, p, e.b))
+            continue;
+
+        smallestAngle = scores.angle[i];
+        smallest = i;
+    }
+
+    if (smallestAngle != std::numeric_limits<float>::infinity()) {
+        const Vector3f centerOfSmallest{scores.x[smallest], scores.y[smallest], scores.z[smallest]};
+        if (grid.BallIsEmpty(centerOfSmallest, radius, {e.a, e.b, e.opposite})) {
+            return PivotResult{neighborhood[smallest], centerOfSmallest};
+        }
+    }
+
+    return {};
+}
+
+bool NotUsed(const Grid& grid, uint32_t p) {
+    return !grid.points_[p].used;
+}
+
+bool OnFront(const Grid& grid, uint32_t p) {
+    return grid.points_[p].frontEdges != 0;
+}
+
+//Takes an edge off the front, keeping the front size and the point counters in step
+void Deactivate(MeshEdge& edge, EdgeStatus status, Grid& grid, Front& front) {
+    if (edge.status == EdgeStatus::active) {
+        front.active--;
+        grid.points_[edge.a].frontEdges--;
+        grid.points_[edge.b].frontEdges--;
+    }
+    edge.status = status;
+}
+
+void Remove(MeshEdge& edge, Grid& grid, Front& front) {
+    Deactivate(edge, EdgeStatus::inner, grid, front);
+}
+
+void OutputTriangle(MeshFace f, const Grid& grid, std::vector<IndexedTriangle>& triangles) {
+    triangles.push_back({grid.points_[f[0]].index, grid.points_[f[1]].index, grid.points_[f[2]].index});
+}
+
+//Files the edge under its point pair, behind the edges of the pair created before it
+void RegisterEdge(MeshState& mesh, uint32_t index) {
+    const auto& edge = mesh.edges[index];
+    auto e = mesh.pairs.Insert(edge.a, edge.b, index);
+    while (e != NoEdge) {
+        auto& same = mesh.edges[e];
+        if (same.samePair == NoEdge) {
+            same.samePair = index;
+            break;
+        }
+        e = same.samePair;
+    }
+}
+
+//Appends the active edge a -> b of the face (a, b, opposite) to the mesh and its front
+uint32_t AddEdge(uint32_t a, uint32_t b, uint32_t opposite, const Vector3f& center, Grid& grid, MeshState& mesh) {
+    const auto index = static_cast<uint32_t>(mesh.edges.size());
+    mesh.edges.push_back(MeshEdge{a, b, opposite, center});
+    RegisterEdge(mesh, index);
+    grid.points_[a].frontEdges++;
+    grid.points_[b].frontEdges++;
+    PushFront(index, grid, mesh);
+    mesh.front.active++;
+    return index;
+}
+
+std::tuple<uint32_t, uint32_t>
+Join(uint32_t e_ij, uint32_t o_k, const Vector3f& o_k_ballCenter, Grid& grid, MeshState& mesh) {
+    const auto i = mesh.edges[e_ij].a;
+    const auto j = mesh.edges[e_ij].b;
+    const auto e_ik = AddEdge(i, o_k, j, o_k_ballCenter, grid, mesh);
+    const auto e_kj = AddEdge(o_k, j, i, o_k_ballCenter, grid, mesh);
+
+    auto& edges = mesh.edges;
+    edges[e_ik].next = e_kj;
+    edges[e_ik].prev = edges[e_ij].prev;
+    edges[edges[e_ij].prev].next = e_ik;
+
+    edges[e_kj].prev = e_ik;
+    edges[e_kj].next = edges[e_ij].next;
+    edges[edges[e_ij].next].prev = e_kj;
+
+    grid.points_[o_k].used = true;
+    Remove(edges[e_ij], grid, mesh.front);
+
+    return {e_ik, e_kj};
+}
+
+void Glue(uint32_t a, uint32_t b, Grid& grid, MeshState& mesh) {
+    auto& edges = mesh.edges;
+    auto& ea = edges[a];
+    auto& eb = edges[b];
+
+    if (ea.next == b && ea.prev == b && eb.next == a && eb.prev == a) {
+        Remove(ea, grid, mesh.front);
+        Remove(eb, grid, mesh.front);
+        return;
+    }
+
+    if (ea.next == b && eb.prev == a) {
+        edges[ea.prev].next = eb.next;
+        edges[eb.next].prev = ea.prev;
+        Remove(ea, grid, mesh.front);
+        Remove(eb, grid, mesh.front);
+        return;
+    }
+    if (ea.prev == b && eb.next == a) {
+        edges[ea.next].prev = eb.prev;
+        edges[eb.prev].next = ea.next;
+        Remove(ea, grid, mesh.front);
+        Remove(eb, grid, mesh.front);
+        return;
+    }
+
+    edges[ea.prev].next = eb.next;
+    edges[eb.next].prev = ea.prev;
+    edges[ea.next].prev = eb.prev;
+    edges[eb.prev].next = ea.next;
+    Remove(ea, grid, mesh.front);
+    Remove(eb, grid, mesh.front);
+}
+
+std::optional<uint32_t> FindReverseEdge(const MeshState& mesh, uint32_t edge) {
+    const auto e = mesh.pairs.Find(mesh.edges[edge].b, mesh.edges[edge].a);
+    if (e == NoEdge)
+        return {};
+    return e;
+}
+
+//Hands out seeds for the parts of the surface no front has reached yet, in the order a serial scan over the cells
+//would find them. Cells below cursor_ hold no seed: seeds need unused points and points only ever become used,
+//so every cell is searched about once per radius however many components the cloud has.
+//Seeds are prefetched for several cells at once; a prefetched seed whose points a front has used since is
+//replaced by searching its cell again.
+class SeedSource {
+public:
+    //Neighborhoods of the workers are allocated from memory, which must be thread safe
+    SeedSource(Grid& grid, float radius, size_t threads, std::pmr::memory_resource* memory, const CancellationToken& cancellation)
+        : grid_(grid), radius_(radius), threads_(ResolveThreadCount(threads)), cancellation_(cancellation) {
+        //Copies of a pmr vector would fall back to the default resource
+        workerNeighborhoods_.reserve(threads_);
+        for (size_t t = 0; t < threads_; ++t)
+            workerNeighborhoods_.emplace_back(memory);
+    }
+
+    std::optional<SeedResult> Next() {
+        while (!cancellation_.IsCancelled()) {
+            //A front grown from the cursor cell may have left another separate part of the surface in it
+            if (revisit_) {
+                revisit_ = false;
+                if (auto seed = FindSeedInCell(grid_, cursor_, radius_, workerNeighborhoods_.front())) {
+                    revisit_ = true;
+                    return seed;
+                }
+                cursor_++;
+            }
+
+            if (next_ == pending_.size()) {
+                pending_ = FindSeedTriangles(grid_, radius_, cursor_, threads_, threads_, workerNeighborhoods_, cancellation_);
+                next_ = 0;
+                if (pending_.empty())
+                    return {};
+            }
+
+            const auto& candidate = pending_[next_++];
+            cursor_ = candidate.cell;
+            revisit_ = true;
+            if (std::none_of(candidate.seed.f.begin(), candidate.seed.f.end(), [&](uint32_t p) { return grid_.points_[p].used; }))
+                return candidate.seed;
+        }
+        return {};
+    }
+
+private:
+    Grid& grid_;
+    float radius_;
+    size_t threads_;
+    const CancellationToken& cancellation_;
+    size_t cursor_ = 0;
+    bool revisit_ = false;
+    std::vector<SeedCandidate> pending_;
+    size_t next_ = 0;
+    std::vector<Neighborhood> workerNeighborhoods_;
+};
+
+void StartFront(const SeedResult& seedResult, Grid& grid, MeshState& mesh) {
+    auto [seed, ballCenter] = seedResult;
+    for (const auto p : seed)
+        grid.points_[p].used = true;
+    mesh.pointsUsed += 3;
+    OutputTriangle(seed, grid, mesh.triangles);
+    const auto e0 = AddEdge(seed[0], seed[1], seed[2], ballCenter, grid, mesh);
+    const auto e1 = AddEdge(seed[1], seed[2], seed[0], ballCenter, grid, mesh);
+    const auto e2 = AddEdge(seed[2], seed[0], seed[1], ballCenter, grid, mesh);
+    auto& edges = mesh.edges;
+    edges[e0].prev = edges[e1].next = e2;
+    edges[e0].next = edges[e2].prev = e1;
+    edges[e1].prev = edges[e2].next = e0;
+}
+
+//Joining e_ij to k must not add a second copy of a half-edge the mesh already has, that face would overlap an
+//existing one and with cocircular points the front could keep regrowing it when edges are not taken newest first
+bool DuplicatesEdge(const MeshState& mesh, const MeshEdge& e_ij, uint32_t k) {
+    return mesh.pairs.Find(e_ij.a, k) != NoEdge || mesh.pairs.Find(k, e_ij.b) != NoEdge;
+}
+
+//Pivots the ball around e_ij and either grows the mesh over the point it hits or marks e_ij as boundary
+void PivotEdge(uint32_t e_ij, Grid& grid, float radius, MeshState& mesh, PivotScratch& scratch) {
+    const auto o_k = BallPivot(mesh.edges[e_ij], grid, radius, mesh, scratch);
+    if (o_k && (NotUsed(grid, o_k->p) || OnFront(grid, o_k->p)) && !DuplicatesEdge(mesh, mesh.edges[e_ij], o_k->p)) {
+        if (NotUsed(grid, o_k->p)) mesh.pointsUsed++;
+        OutputTriangle({{mesh.edges[e_ij].a, o_k->p, mesh.edges[e_ij].b}}, grid, mesh.triangles);
+        auto [e_ik, e_kj] = Join(e_ij, o_k->p, o_k->center, grid, mesh);
+        if (const auto e_ki = FindReverseEdge(mesh, e_ik)) Glue(e_ik, e_ki.value(), grid, mesh);
+        if (const auto e_jk = FindReverseEdge(mesh, e_kj)) Glue(e_kj, e_jk.value(), grid, mesh);
+    } else {
+        Deactivate(mesh.edges[e_ij], EdgeStatus::boundary, grid, mesh.front);
+    }
+}
+
+//Boundary edges get another pivot with the next, larger ball, centered over the face they belong to
+void ReactivateBoundary(MeshState& mesh, Grid& grid, float radius) {
+    for (uint32_t i = 0; i < mesh.edges.size(); ++i) {
+        auto& e = mesh.edges[i];
+        if (e.status != EdgeStatus::boundary) continue;
+        if (const auto center = ComputeBallCenter(GetPositions(grid, {{e.a, e.b, e.opposite}}), radius))
+            e.center = center.value();
+        e.status = EdgeStatus::active;
+        grid.points_[e.a].frontEdges++;
+        grid.points_[e.b].frontEdges++;
+        PushFront(i, grid, mesh);
+        mesh.front.active++;
+    }
+}
+
+//Layers [begin, end) of grid cells along axis owned by one worker of the parallel mode.
+//A worker only pivots edges and seeds whose whole neighborhood lies in its own layers, so every point it reads
+//the edges of or modifies belongs to it alone. Other edges are deferred to the serial stitching pass.
+struct Slab {
+    int axis;
+    int begin;
+    int end;
+    int dims;
+
+    //Layers [FirstLayer(), EndLayer()) are grown by the slab, the ones within reach of a neighbouring slab are left
+    //to the stitching pass
+    int FirstLayer(int reach) const { return begin == 0 ? 0 : begin + reach; }
+    int EndLayer(int reach) const { return end == dims ? dims : end - reach; }
+
+    bool Contains(int layer, int reach) const {
+        return layer >= FirstLayer(reach) && layer < EndLayer(reach);
+    }
+};
+
+//A partition allocates from its own arena, so workers never share one
+struct Partition {
+    Partition(const Slab& slab, FrontOrder order, std::pmr::memory_resource* upstream)
+        : slab(slab), arena(upstream), mesh(order, &arena), deferred(&arena) { }
+
+    Slab slab;
+    std::pmr::monotonic_buffer_resource arena;
+    MeshState mesh;
+    std::pmr::vector<uint32_t> deferred;
+};
+
+//Splits the longest grid axis into at most count slabs holding similar numbers of points
+std::vector<Slab> MakeSlabs(Grid& grid, size_t count, int reach) {
+    int axis = 0;
+    for (auto i = 1; i < 3; i++)
+        if (grid.dims_[i] > grid.dims_[axis]) axis = i;
+
+    //Thinner slabs would defer nearly all of their edges
+    const int minLayers = 4 * reach + 4;
+    const int dims = grid.dims_[axis];
+    count = std::min<size_t>(count, dims / minLayers);
+    if (count < 2)
+        return {};
+
+    std::vector<size_t> layerPoints(dims, 0);
+    for (size_t c = 0; c < grid.CellCount(); ++c) {
+        const auto size = grid.GetCell(c).size();
+        if (size != 0) layerPoints[grid.GetCellIndexOf(c)[axis]] += size;
+    }
+
+    std::vector<Slab> slabs;
+    const size_t target = (grid.points_.size() + count - 1) / count;
+    int begin = 0;
+    size_t points = 0;
+    for (int layer = 0; layer < dims; ++layer) {
+        points += layerPoints[layer];
+        const bool lastSlab = slabs.size() + 1 == count;
+        if (!lastSlab && points >= target && layer + 1 - begin >= minLayers && dims - (layer + 1) >= minLayers) {
+            slabs.push_back({axis, begin, layer + 1, dims});
+            begin = layer + 1;
+            points = 0;
+        }
+    }
+    slabs.push_back({axis, begin, dims, dims});
+    return slabs;
+}
+
+void GrowPartition(Partition& partition, Grid& grid, float radius, const CancellationToken& cancellation) {
+    const int reach = grid.Reach(radius);
+    const int axis = partition.slab.axis;
+    auto& mesh = partition.mesh;
+    PivotScratch scratch(&partition.arena);
+
+    //Grows every front a cell seeds, false once cancelled
+    const auto growFrom = [&](size_t c) {
+        //A cell may seed several separate parts of the surface
+        while (const auto seed = FindSeedInCell(grid, c, radius, scratch.neighborhood)) {
+            StartFront(seed.value(), grid, mesh);
+            while (const auto e_ij = GetActiveEdge(mesh)) {
+                if (cancellation.IsCancelled())
+                    return false;
+
+                const auto& edge = mesh.edges[e_ij.value()];
+                const auto m = (grid.Position(edge.a) + grid.Position(edge.b)) / 2.0f;
+                if (!partition.slab.Contains(grid.GetCellIndex(m)[axis], reach)) {
+                    partition.deferred.push_back(e_ij.value());
+                    continue;
+                }
+                PivotEdge(e_ij.value(), grid, radius, mesh, scratch);
+            }
+        }
+        return true;
+    };
+
+    //Only the cells of the slab's own layers are visited, in ascending linear order
+    Grid::CellIndex lower{0, 0, 0};
+    Grid::CellIndex upper = grid.dims_;
+    lower[axis] = partition.slab.FirstLayer(reach);
+    upper[axis] = partition.slab.EndLayer(reach);
+    for (auto z = lower[2]; z < upper[2]; z++) {
+        for (auto y = lower[1]; y < upper[1]; y++) {
+            for (auto x = lower[0]; x < upper[0]; x++) {
+                if (!growFrom(grid.GetLinearIndex({x, y, z})))
+                    return;
+            }
+        }
+    }
+}
+
+//Moves the edges and triangles of a grown partition behind the ones of mesh,
+//its deferred edges are still active and join the front of mesh
+void MergePartition(Partition& partition, const Grid& grid, MeshState& mesh) {
+    auto& part = partition.mesh;
+    const auto offset = static_cast<uint32_t>(mesh.edges.size());
+    for (auto edge : part.edges) {
+        edge.prev += offset;
+        edge.next += offset;
+        edge.samePair = NoEdge;
+        mesh.edges.push_back(edge);
+        RegisterEdge(mesh, static_cast<uint32_t>(mesh.edges.size() - 1));
+    }
+    for (const auto e : partition.deferred)
+        PushFront(e + offset, grid, mesh);
+    mesh.front.active += part.front.active;
+    mesh.triangles.insert(mesh.triangles.end(), part.triangles.begin(), part.triangles.end());
+    mesh.pointsUsed += part.pointsUsed;
+    part.triangles = {};
+}
+
+//Returns the triangles, or hands them to sink in batches and returns none when it is set
+std::vector<IndexedTriangle> ReconstructIndexed(const PointCloudView& cloud, const std::vector<float>& radii, const BallPivotingOptions& options,
+                                                const TriangleSink* sink = nullptr);
+
+std::vector<Triangle> DoBallPivotingAlgorithm(const std::vector<GeneratedPoint>& points, float radius) {
+    return DoBallPivotingAlgorithm(points, std::vector<float>{radius}, BallPivotingOptions{});
+}
+
+std::vector<Triangle> DoBallPivotingAlgorithm(const std::vector<GeneratedPoint>& points, float radius, const BallPivotingOptions& options) {
+    return DoBallPivotingAlgorithm(points, std::vector<float>{radius}, options);
+}
+
+std::vector<Triangle> DoBallPivotingAlgorithm(const std::vector<GeneratedPoint>& points, const std::vector<float>& radii, const BallPivotingOptions& options) {
+    const auto indices = ReconstructIndexed(PointCloud(points), radii, options);
+
+    std::vector<Triangle> triangles;
+    triangles.reserve(indices.size());
+    for (const auto& triangle : indices)
+        triangles.push_back({points[triangle[0]], points[triangle[1]], points[triangle[2]]});
+    return triangles;
+}
+
+IndexedMesh DoBallPivotingAlgorithmIndexed(PointCloud points, const std::vector<float>& radii, const BallPivotingOptions& options) {
+    auto triangles = ReconstructIndexed(points, radii, options);
+    return IndexedMesh{std::move(points), std::move(triangles)};
+}
+
+IndexedMesh DoBallPivotingAlgorithmIndexed(const std::vector<GeneratedPoint>& points, const std::vector<float>& radii, const BallPivotingOptions& options) {
+    return DoBallPivotingAlgorithmIndexed(PointCloud(points), radii, options);
+}
+
+std::vector<IndexedTriangle> DoBallPivotingAlgorithmIndexed(const PointCloudView& points, const std::vector<float>& radii, const BallPivotingOptions& options) {
+    return ReconstructIndexed(points, radii, options);
+}
+
+void DoBallPivotingAlgorithmStreamed(const PointCloudView& points, const std::vector<float>& radii, const BallPivotingOptions& options, const TriangleSink& sink) {
+    ReconstructIndexed(points, radii, options, &sink);
+}
+
+std::vector<IndexedTriangle> ReconstructIndexed(const PointCloudView& cloud, const std::vector<float>& radii, const BallPivotingOptions& options,
+                                                const TriangleSink* sink) {
+    if (cloud.empty() || radii.empty())
+        return {};
+
+    auto sortedRadii = radii;
+    std::sort(begin(sortedRadii), end(sortedRadii));
+    sortedRadii.erase(std::unique(begin(sortedRadii), end(sortedRadii)), end(sortedRadii));
+    if (!(sortedRadii.front() > 0))
+        throw std::invalid_argument("ball radii must be positive");
+
+    //Cells fit the smallest ball, larger balls scan more cells of the same grid
+    Grid grid(cloud, sortedRadii.front(), options.threads, options.mortonOrder);
+
+    //Edges, lookup tables and scratch buffers of the run, released together when it returns
+    LockedResource upstream(options.memory ? options.memory : std::pmr::get_default_resource());
+    std::pmr::monotonic_buffer_resource arena(&upstream);
+
+    //Reused by every pivot of the run
+    PivotScratch scratch(&arena);
+
+    MeshState mesh(options.frontOrder, &arena);
+    std::deque<Partition> partitions;
+
+    //Triangles already given to the sink, the ones still in mesh.triangles follow them
+    size_t handedOver = 0;
+    const auto emitted = [&]() { return handedOver + mesh.triangles.size(); };
+    const auto handOver = [&](size_t minimum) {
+        if (!sink || mesh.triangles.empty() || mesh.triangles.size() < minimum)
+            return;
+        (*sink)(mesh.triangles.data(), mesh.triangles.size());
+        handedOver += mesh.triangles.size();
+        mesh.triangles.clear();
+    };
+    const size_t batch = std::max<size_t>(options.triangleBatch, 1);
+
+    BallPivotingProgress progress{0, cloud.size(), 0, 0};
+    const auto reportProgress = [&]() {
+        if (!options.progress) return;
+        progress.pointsUsed = mesh.pointsUsed;
+        progress.frontSize = mesh.front.active;
+        progress.trianglesEmitted = emitted();
+        options.progress(progress);
+    };
+
+    if (options.parallelPivoting) {
+        const float radius = sortedRadii.front();
+        for (const auto& slab : MakeSlabs(grid, ResolveThreadCount(options.threads), grid.Reach(radius)))
+            partitions.emplace_back(slab, options.frontOrder, &upstream);
+
+        ParallelForChunks(partitions.size(), partitions.size(), [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                GrowPartition(partitions[i], grid, radius, options.cancellation);
+        });
+
+        //Deferred edges become the front of the stitching pass
+        for (auto& partition : partitions) {
+            MergePartition(partition, grid, mesh);
+            handOver(batch);
+        }
+    }
+
+    size_t nextReport = options.progressInterval;
+    const auto expandFront = [&](float radius) {
+        while (const auto e_ij = GetActiveEdge(mesh)) {
+            if (options.cancellation.IsCancelled())
+                return;
+
+            PivotEdge(e_ij.value(), grid, radius, mesh, scratch);
+            handOver(batch);
+
+            if (emitted() >= nextReport) {
+                reportProgress();
+                nextReport = emitted() + options.progressInterval;
+            }
+        }
+    };
+
+    for (const float radius : sortedRadii) {
+        if (options.cancellation.IsCancelled())
+            break;
+
+        if (radius != sortedRadii.front())
+            ReactivateBoundary(mesh, grid, radius);
+
+        reportProgress();
+        expandFront(radius);
+
+        //Every part of the surface the front did not reach starts from its own seed
+        SeedSource seeds(grid, radius, options.threads, &upstream, options.cancellation);
+        while (const auto seed = seeds.Next()) {
+            StartFront(seed.value(), grid, mesh);
+            expandFront(radius);
+        }
+    }
+
+    handOver(1);
+    reportProgress();
+    return std::move(mesh.triangles);
+}
+
+std::future<std::vector<Triangle>> DoBallPivotingAlgorithmAsync(std::vector<GeneratedPoint> points, float radius, BallPivotingOptions options) {
+    return std::async(std::launch::async, [points = std::move(points), radius, options = std::move(options)]() {
+        return DoBallPivotingAlgorithm(points, radius, options);
+    });
+}
+
+std::future<std::vector<Triangle>> DoBallPivotingAlgorithmAsync(std::vector<GeneratedPoint> points, std::vector<float> radii, BallPivotingOptions options) {
+    return std::async(std::launch::async, [points = std::move(points), radii = std::move(radii), options = std::move(options)]() {
+        return DoBallPivotingAlgorithm(points, radii, options);
+    });
+}
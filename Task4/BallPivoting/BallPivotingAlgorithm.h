@@ -0,0 +1,149 @@
+#ifndef BALLPIVOTINGALGORITHM_H
+#define BALLPIVOTINGALGORITHM_H
+
+#include <array>
+#include <cstdint>
+#include <atomic>
+#include <vector>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <memory>
+#include <memory_resource>
+#include <numbers>
+#include "DataStructures.h"
+#include "PointCloud.h"
+
+struct Triangle : std::array<GeneratedPoint, 3> {
+public:
+
+    GeneratedPoint GetNormUnitVector() const {
+        float x1 = (*this)[0].x - (*this)[1].x,
+              y1 = (*this)[0].y - (*this)[1].y,
+              z1 = (*this)[0].z - (*this)[1].z;
+
+        float x2 = (*this)[0].x - (*this)[2].x,
+              y2 = (*this)[0].y - (*this)[2].y,
+              z2 = (*this)[0].z - (*this)[2].z;
+
+        float xNorm = y1 * z2 - z1 * y2,
+              yNorm = z1 * x2 - x1 * z2,
+              zNorm = x1 * y2 - y1 * x2;
+
+        float vectorMagnitude = sqrt(xNorm * xNorm + yNorm * yNorm + zNorm * zNorm);
+
+        float xUnit = xNorm / vectorMagnitude,
+              yUnit = yNorm / vectorMagnitude,
+              zUnit = zNorm / vectorMagnitude;
+
+        return { xUnit,
+                 yUnit,
+                 zUnit,
+                 -1.0,
+                 -1.0,
+                 -1.0};
+    }
+
+};
+
+//Indices of a triangle's corners in the reconstructed point cloud, counter-clockwise seen from the side the point normals face
+using IndexedTriangle = std::array<uint32_t, 3>;
+
+struct IndexedMesh {
+    PointCloud vertices;
+    std::vector<IndexedTriangle> triangles;
+};
+
+//Shared flag, copies of a token observe the same cancellation
+class CancellationToken {
+public:
+    CancellationToken() : cancelled_(std::make_shared<std::atomic<bool>>(false)) { }
+
+    void Cancel() const { cancelled_->store(true, std::memory_order_relaxed); }
+    bool IsCancelled() const { return cancelled_->load(std::memory_order_relaxed); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+struct BallPivotingProgress {
+    size_t pointsUsed;
+    size_t pointsTotal;
+    size_t frontSize;
+    size_t trianglesEmitted;
+};
+
+//Order in which the edges of the front are pivoted. The mesh can differ slightly between orders.
+enum class FrontOrder {
+    //Newest edge first
+    lifo,
+    //Oldest edge first, fronts grow in rings around their seeds
+    fifo,
+    //Edge whose midpoint cell comes first in Morton order, consecutive pivots stay in neighbouring cells
+    spatial
+};
+
+//Receives triangles in batches while the reconstruction runs, the pointer is only valid during the call
+using TriangleSink = std::function<void(const IndexedTriangle* triangles, size_t count)>;
+
+struct BallPivotingOptions {
+    //Called on the reconstructing thread after the seed, every progressInterval triangles and at the end
+    std::function<void(const BallPivotingProgress&)> progress;
+    size_t progressInterval = 4096;
+
+    //Checked once per front edge, a cancelled run returns the triangles built so far
+    CancellationToken cancellation;
+
+    //Worker threads for the parallel stages, 0 picks std::thread::hardware_concurrency()
+    size_t threads = 0;
+
+    //Grows independent fronts in slabs of the grid, one per thread, then stitches the edges left at slab borders
+    //in a serial pass. The mesh matches the serial one where the sampling is uniform, triangle order differs.
+    bool parallelPivoting = false;
+
+    FrontOrder frontOrder = FrontOrder::lifo;
+
+    //Stores the occupied grid cells along the Morton curve instead of in z-y-x order, so the cells a neighborhood
+    //or empty ball query visits lie closer together in memory. Seeds are still searched in z-y-x cell order and
+    //the mesh is the same either way.
+    bool mortonOrder = false;
+
+    //Upstream of the per-run arenas holding the edges, lookup tables and neighborhood buffers. Arenas only grow
+    //during a run and hand their memory back in one go when it ends. Calls into the resource are serialised,
+    //so it need not be thread safe. Null uses std::pmr::get_default_resource().
+    std::pmr::memory_resource* memory = nullptr;
+
+    //Triangles collected before a streamed run hands them to its sink
+    size_t triangleBatch = 65536;
+};
+
+std::vector<Triangle> DoBallPivotingAlgorithm(const std::vector<GeneratedPoint>& points, float radius);
+
+std::vector<Triangle> DoBallPivotingAlgorithm(const std::vector<GeneratedPoint>& points, float radius, const BallPivotingOptions& options);
+
+//Reconstructs every connected part of the surface, each grown from its own seed triangle.
+//Pivots with every radius in ascending order over one grid and one front: after the front of a radius is exhausted
+//its boundary edges are pivoted again with the next radius, closing holes left by uneven sampling.
+//Throws std::invalid_argument for non-positive radii.
+std::vector<Triangle> DoBallPivotingAlgorithm(const std::vector<GeneratedPoint>& points, const std::vector<float>& radii, const BallPivotingOptions& options);
+
+//Same reconstruction returning the input points as a shared vertex buffer and three indices in input order per triangle,
+//a quarter of the memory of full Triangle copies. Move the points in to avoid copying them into the result.
+IndexedMesh DoBallPivotingAlgorithmIndexed(PointCloud points, const std::vector<float>& radii, const BallPivotingOptions& options);
+
+IndexedMesh DoBallPivotingAlgorithmIndexed(const std::vector<GeneratedPoint>& points, const std::vector<float>& radii, const BallPivotingOptions& options);
+
+//Triangles only, for points the caller keeps alive such as a memory mapped cloud, which are read in place
+std::vector<IndexedTriangle> DoBallPivotingAlgorithmIndexed(const PointCloudView& points, const std::vector<float>& radii, const BallPivotingOptions& options);
+
+//Hands the triangles to sink in batches of about options.triangleBatch as they are built instead of returning them,
+//so only one batch is held at a time. The sink is called on the reconstructing thread. With parallelPivoting the
+//triangles of the slabs are handed over after the slabs are stitched, the ones of the stitching pass as they come.
+void DoBallPivotingAlgorithmStreamed(const PointCloudView& points, const std::vector<float>& radii, const BallPivotingOptions& options, const TriangleSink& sink);
+
+//Runs the reconstruction on a worker thread, the points are moved into the task
+std::future<std::vector<Triangle>> DoBallPivotingAlgorithmAsync(std::vector<GeneratedPoint> points, float radius, BallPivotingOptions options);
+
+std::future<std::vector<Triangle>> DoBallPivotingAlgorithmAsync(std::vector<GeneratedPoint> points, std::vector<float> radii, BallPivotingOptions options);
+
+#endif // BALLPIVOTINGALGORITHM_H
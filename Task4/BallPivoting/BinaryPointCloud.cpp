@@ -0,0 +1,155 @@
+#include "BinaryPointCloud.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "Grid.h"
+
+namespace {
+
+constexpr char Magic[8] = {'B', 'P', 'C', 'L', 'O', 'U', 'D', '\0'};
+constexpr uint32_t Version = 1;
+//Reads back as 0x04030201 on a host of the other byte order
+constexpr uint32_t ByteOrderMark = 0x01020304;
+constexpr uint32_t HasNormals = 1;
+
+//Arrays start on this boundary of the file, mapped files start on a page so they stay aligned in memory
+constexpr size_t ArrayAlignment = 64;
+
+//Floats converted per write when writing from GeneratedPoint vectors
+constexpr size_t WriteBatch = size_t{1} << 16;
+
+//Members stored in the six arrays, in file order
+constexpr std::array<float GeneratedPoint::*, 6> Components{
+    &GeneratedPoint::x, &GeneratedPoint::y, &GeneratedPoint::z,
+    &GeneratedPoint::n_x, &GeneratedPoint::n_y, &GeneratedPoint::n_z };
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t flags;
+    uint32_t reserved0;
+    uint64_t count;
+    float lower[3];
+    float upper[3];
+    uint8_t reserved1[8];
+};
+
+static_assert(sizeof(Header) == 64, "the header fills the first 64 bytes");
+
+//Bytes of one array with the padding up to the next one
+uint64_t ArrayStride(uint64_t count) {
+    return (count * sizeof(float) + ArrayAlignment - 1) / ArrayAlignment * ArrayAlignment;
+}
+
+Header MakeHeader(uint64_t count, const CloudBounds& bounds) {
+    Header header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.byteOrder = ByteOrderMark;
+    header.flags = HasNormals;
+    header.count = count;
+    for (auto axis = 0; axis < 3; axis++) {
+        header.lower[axis] = bounds.lower[axis];
+        header.upper[axis] = bounds.upper[axis];
+    }
+    return header;
+}
+
+//Writes the header, then calls writeArray(out, component) for the six arrays and pads each to the stride
+template <typename WriteArray>
+void WriteCloud(const std::string& fileName, uint64_t count, const CloudBounds& bounds, WriteArray&& writeArray) {
+    std::ofstream out(fileName, std::ios::binary);
+    if (!out) throw std::runtime_error("cannot open " + fileName);
+
+    const auto header = MakeHeader(count, bounds);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    const std::array<char, ArrayAlignment> padding{};
+    const auto paddingSize = static_cast<std::streamsize>(ArrayStride(count) - count * sizeof(float));
+    for (size_t component = 0; component < Components.size(); ++component) {
+        writeArray(out, component);
+        out.write(padding.data(), paddingSize);
+    }
+
+    if (!out) throw std::runtime_error("failed writing " + fileName);
+}
+
+void WriteFloats(std::ofstream& out, const float* values, size_t count) {
+    out.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(count * sizeof(float)));
+}
+
+}
+
+void WriteBinaryPointCloud(const std::string& fileName, const PointCloudView& points) {
+    const std::array<const float*, 6> arrays{ points.x(), points.y(), points.z(), points.n_x(), points.n_y(), points.n_z() };
+    const auto bounds = points.empty() ? CloudBounds{} : ComputeBounds(points, 1);
+    WriteCloud(fileName, points.size(), bounds, [&](std::ofstream& out, size_t component) {
+        WriteFloats(out, arrays[component], points.size());
+    });
+}
+
+void WriteBinaryPointCloud(const std::string& fileName, const std::vector<GeneratedPoint>& points) {
+    CloudBounds bounds{};
+    if (!points.empty()) {
+        bounds = {points.front(), points.front()};
+        for (const auto& point : points) {
+            for (auto axis = 0; axis < 3; axis++) {
+                bounds.lower[axis] = std::min(bounds.lower[axis], point[axis]);
+                bounds.upper[axis] = std::max(bounds.upper[axis], point[axis]);
+            }
+        }
+    }
+
+    //Components are gathered in batches, the points are never copied into arrays as a whole
+    std::vector<float> batch(std::min(WriteBatch, points.size()));
+    WriteCloud(fileName, points.size(), bounds, [&](std::ofstream& out, size_t component) {
+        for (size_t begin = 0; begin < points.size(); begin += batch.size()) {
+            const size_t end = std::min(points.size(), begin + batch.size());
+            for (size_t i = begin; i < end; ++i)
+                batch[i - begin] = points[i].*Components[component];
+            WriteFloats(out, batch.data(), end - begin);
+        }
+    });
+}
+
+bool IsBinaryPointCloud(const std::string& fileName) {
+    std::ifstream in(fileName, std::ios::binary);
+    char magic[sizeof(Magic)] = {};
+    in.read(magic, sizeof(magic));
+    return in && std::memcmp(magic, Magic, sizeof(Magic)) == 0;
+}
+
+MappedPointCloud::MappedPointCloud(const std::string& fileName)
+    : file_(fileName) {
+    if (file_.size() < sizeof(Header))
+        throw std::runtime_error(fileName + ": not a binary point cloud");
+
+    Header header;
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0)
+        throw std::runtime_error(fileName + ": not a binary point cloud");
+    if (header.byteOrder != ByteOrderMark)
+        throw std::runtime_error(fileName + ": binary point cloud written with the other byte order");
+    if (header.version != Version)
+        throw std::runtime_error(fileName + ": unsupported binary point cloud version " + std::to_string(header.version));
+    if (!(header.flags & HasNormals))
+        throw std::runtime_error(fileName + ": binary point cloud has no normals");
+    if (header.count > (file_.size() - sizeof(Header)) / (6 * sizeof(float))
+            || sizeof(Header) + 6 * ArrayStride(header.count) > file_.size())
+        throw std::runtime_error(fileName + ": binary point cloud is truncated");
+
+    const auto stride = ArrayStride(header.count);
+    const auto array = [&](size_t component) {
+        return reinterpret_cast<const float*>(file_.data() + sizeof(Header) + component * stride);
+    };
+    view_ = PointCloudView(static_cast<size_t>(header.count), array(0), array(1), array(2), array(3), array(4), array(5));
+
+    for (auto axis = 0; axis < 3; axis++) {
+        bounds_.lower[axis] = header.lower[axis];
+        bounds_.upper[axis] = header.upper[axis];
+    }
+}
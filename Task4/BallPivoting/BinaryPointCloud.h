@@ -0,0 +1,41 @@
+#ifndef BINARYPOINTCLOUD_H
+#define BINARYPOINTCLOUD_H
+
+#include <string>
+#include <vector>
+#include "DataStructures.h"
+#include "MappedFile.h"
+#include "PointCloud.h"
+
+//Binary point cloud file (.bpc) in host byte order:
+//  64 byte header: magic "BPCLOUD", version, byte order mark, flags, point count, lower and upper bounds
+//  x, y, z, n_x, n_y, n_z arrays of count floats each, every array starting on a 64 byte boundary of the file
+//A mapped file is used in place, loading it neither parses nor copies the points.
+
+//Throws std::runtime_error when the file cannot be written
+void WriteBinaryPointCloud(const std::string& fileName, const PointCloudView& points);
+
+void WriteBinaryPointCloud(const std::string& fileName, const std::vector<GeneratedPoint>& points);
+
+//True when the file starts with the binary cloud magic
+bool IsBinaryPointCloud(const std::string& fileName);
+
+//Memory mapped binary cloud, its view reads the file pages directly and stays valid while the object lives.
+//Throws std::runtime_error for files that are not binary clouds, are truncated or use the other byte order.
+class MappedPointCloud {
+public:
+    explicit MappedPointCloud(const std::string& fileName);
+
+    PointCloudView View() const { return view_; }
+    operator PointCloudView() const { return view_; }
+
+    //Bounds stored by the writer
+    const CloudBounds& Bounds() const { return bounds_; }
+
+private:
+    MappedFile file_;
+    PointCloudView view_;
+    CloudBounds bounds_;
+};
+
+#endif // BINARYPOINTCLOUD_H
@@ -0,0 +1,215 @@
+#include "Grid.h"
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <stdexcept>
+#include "MortonOrder.h"
+#include "Parallel.h"
+
+namespace {
+
+//Per-thread histograms cost threads * cells counters, keep them within a few counters per point
+constexpr size_t HistogramEntriesPerPoint = 4;
+
+//Fraction of the squared radius a point may reach into the ball without counting as inside. Relative, so it
+//absorbs the rounding of centers computed from three points at every scale without switching off small balls.
+constexpr float BallSurfaceTolerance = 1e-4f;
+
+//Points tested at once by the empty ball query, the block test has no branches so it vectorises
+constexpr uint32_t BallTestBlock = 8;
+
+}
+
+CloudBounds ComputeBounds(const PointCloudView& cloud, size_t threads) {
+    const std::array<const float*, 3> coordinates{ cloud.x(), cloud.y(), cloud.z() };
+    std::vector<CloudBounds> partial(threads, CloudBounds{cloud.Position(0), cloud.Position(0)});
+    ParallelForChunks(cloud.size(), threads, [&](size_t t, size_t begin, size_t end) {
+        auto& bounds = partial[t];
+        for (auto axis = 0; axis < 3; axis++) {
+            const float* values = coordinates[axis];
+            for (size_t i = begin; i < end; ++i) {
+                bounds.lower[axis] = std::min(bounds.lower[axis], values[i]);
+                bounds.upper[axis] = std::max(bounds.upper[axis], values[i]);
+            }
+        }
+    });
+
+    auto result = partial.front();
+    for (const auto& bounds : partial) {
+        for (auto axis = 0; axis < 3; axis++) {
+            result.lower[axis] = std::min(result.lower[axis], bounds.lower[axis]);
+            result.upper[axis] = std::max(result.upper[axis], bounds.upper[axis]);
+        }
+    }
+    return result;
+}
+
+Grid::Grid(const PointCloudView& cloud, float radius, size_t threads, bool mortonOrder)
+    : cell_size_(radius * 2) {
+    if (cloud.size() >= std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("too many points for the grid");
+
+    threads = ResolveThreadCount(threads);
+
+    const auto bounds = ComputeBounds(cloud, threads);
+    lower_ = bounds.lower;
+    upper_ = bounds.upper;
+
+    dims_ = Dimensions(bounds, cell_size_);
+    const size_t cellCount = CellCount();
+
+    std::vector<uint32_t> cellOf(cloud.size());
+    ParallelForChunks(cloud.size(), threads, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            cellOf[i] = static_cast<uint32_t>(GetLinearIndex(GetCellIndex(cloud.Position(i))));
+    });
+
+    //Stable counting sort by cell: every thread counts its chunk, then scatters it behind the chunks before it
+    const size_t sortThreads = std::clamp<size_t>(HistogramEntriesPerPoint * cloud.size() / cellCount, 1, threads);
+    std::vector<std::vector<uint32_t>> cursors(sortThreads, std::vector<uint32_t>(cellCount, 0));
+    ParallelForChunks(cloud.size(), sortThreads, [&](size_t t, size_t begin, size_t end) {
+        auto& counts = cursors[t];
+        for (size_t i = begin; i < end; ++i)
+            counts[cellOf[i]]++;
+    });
+
+    //Cells in the order they are stored, only the occupied ones are put on the Morton curve
+    std::vector<uint32_t> storedCells;
+    if (mortonOrder) {
+        for (size_t cell = 0; cell < cellCount; ++cell)
+            if (std::any_of(cursors.begin(), cursors.end(), [cell](const std::vector<uint32_t>& counts) { return counts[cell] != 0; }))
+                storedCells.push_back(static_cast<uint32_t>(cell));
+        SortCellsByMortonCode(storedCells, dims_, threads);
+
+        cell_slots_.assign(cellCount, static_cast<uint32_t>(storedCells.size()));
+        for (size_t slot = 0; slot < storedCells.size(); ++slot)
+            cell_slots_[storedCells[slot]] = static_cast<uint32_t>(slot);
+    }
+
+    const size_t slots = mortonOrder ? storedCells.size() : cellCount;
+    cell_offsets_.resize(slots + 1);
+    uint32_t offset = 0;
+    for (size_t slot = 0; slot < slots; ++slot) {
+        const size_t cell = mortonOrder ? storedCells[slot] : slot;
+        cell_offsets_[slot] = offset;
+        for (auto& counts : cursors) {
+            const auto count = counts[cell];
+            counts[cell] = offset;
+            offset += count;
+        }
+    }
+    cell_offsets_[slots] = offset;
+    //The empty slot shared by the empty cells
+    if (mortonOrder)
+        cell_offsets_.push_back(offset);
+
+    points_.resize(cloud.size());
+    cloud_.resize(cloud.size());
+    ParallelForChunks(cloud.size(), sortThreads, [&](size_t t, size_t begin, size_t end) {
+        auto& cursor = cursors[t];
+        for (size_t i = begin; i < end; ++i) {
+            const auto target = cursor[cellOf[i]]++;
+            points_[target].index = static_cast<uint32_t>(i);
+            cloud_.Set(target, cloud[i]);
+        }
+    });
+}
+
+Grid::CellIndex Grid::Dimensions(const CloudBounds& bounds, float cellSize) {
+    //Widened to double, neither the cells per axis nor their product can overflow before the check
+    CellIndex dims;
+    double cellCount = 1;
+    for (auto axis = 0; axis < 3; axis++) {
+        const auto cells = std::max(1.0, std::ceil(static_cast<double>((bounds.upper[axis] - bounds.lower[axis]) / cellSize)));
+        cellCount *= cells;
+        if (!(cellCount < std::numeric_limits<uint32_t>::max()))
+            throw std::runtime_error("ball radius is too small for the point cloud extent");
+        dims[axis] = static_cast<int>(cells);
+    }
+    return dims;
+}
+
+Grid::CellIndex Grid::GetCellIndex(const GeneratedPoint& point, const GeneratedPoint& lower, float cellSize, const CellIndex& dims) {
+    CellIndex index;
+    for (auto axis = 0; axis < 3; axis++) {
+        const auto cell = static_cast<int>((point[axis] - lower[axis]) / cellSize);
+        index[axis] = std::clamp(cell, 0, dims[axis] - 1);
+    }
+    return index;
+}
+
+void Grid::SphericalNeighborhood(const GeneratedPoint& point, float radius, std::initializer_list<uint32_t> ignore, Neighborhood& result) const {
+    result.clear();
+    const auto centerIndex = GetCellIndex(point);
+    const float searchRadius = radius * 2;
+    const float squaredSearchRadius = searchRadius * searchRadius;
+    const int reach = Reach(radius);
+    const float* xs = cloud_.x();
+    const float* ys = cloud_.y();
+    const float* zs = cloud_.z();
+    for (auto xOff = -reach; xOff <= reach; xOff++) {
+        for (auto yOff = -reach; yOff <= reach; yOff++) {
+            for (auto zOff = -reach; zOff <= reach; zOff++) {
+                const CellIndex index{centerIndex[0] + xOff, centerIndex[1] + yOff, centerIndex[2] + zOff};
+                if (index[0] < 0 || index[0] >= dims_[0]) continue;
+                if (index[1] < 0 || index[1] >= dims_[1]) continue;
+                if (index[2] < 0 || index[2] >= dims_[2]) continue;
+
+                const auto cell = GetCell(index);
+                for (uint32_t i = cell.first; i < cell.last; ++i) {
+                    const float dx = xs[i] - point.x, dy = ys[i] - point.y, dz = zs[i] - point.z;
+                    if (dx * dx + dy * dy + dz * dz >= squaredSearchRadius) continue;
+                    if (std::find(ignore.begin(), ignore.end(), i) != ignore.end()) continue;
+                    result.push_back(i);
+                }
+            }
+        }
+    }
+}
+
+bool Grid::BallIsEmpty(const GeneratedPoint& center, float radius, std::initializer_list<uint32_t> ignore) const {
+    const float limit = radius * radius * (1 - BallSurfaceTolerance);
+    const auto lowerIndex = GetCellIndex(center - GeneratedPoint(radius));
+    const auto upperIndex = GetCellIndex(center + GeneratedPoint(radius));
+    const float* xs = cloud_.x();
+    const float* ys = cloud_.y();
+    const float* zs = cloud_.z();
+
+    const auto inside = [&](uint32_t i) {
+        const float dx = xs[i] - center.x, dy = ys[i] - center.y, dz = zs[i] - center.z;
+        return dx * dx + dy * dy + dz * dz < limit;
+    };
+    const auto counts = [&](uint32_t i) {
+        return inside(i) && std::find(ignore.begin(), ignore.end(), i) == ignore.end();
+    };
+
+    //True when a point of the run [i, last) counts
+    const auto occupied = [&](uint32_t i, uint32_t last) {
+        for (; i + BallTestBlock <= last; i += BallTestBlock) {
+            bool any = false;
+            for (uint32_t k = 0; k < BallTestBlock; ++k)
+                any |= inside(i + k);
+            if (!any) continue;
+            for (uint32_t k = 0; k < BallTestBlock; ++k)
+                if (counts(i + k)) return true;
+        }
+        for (; i < last; ++i)
+            if (counts(i)) return true;
+        return false;
+    };
+
+    for (auto z = lowerIndex[2]; z <= upperIndex[2]; z++) {
+        for (auto y = lowerIndex[1]; y <= upperIndex[1]; y++) {
+            //In linear order cells along x are adjacent in the point array, so each row is one contiguous run
+            if (cell_slots_.empty()) {
+                if (occupied(GetCell({lowerIndex[0], y, z}).first, GetCell({upperIndex[0], y, z}).last)) return false;
+                continue;
+            }
+            for (auto x = lowerIndex[0]; x <= upperIndex[0]; x++) {
+                const auto cell = GetCell({x, y, z});
+                if (occupied(cell.first, cell.last)) return false;
+            }
+        }
+    }
+    return true;
+}
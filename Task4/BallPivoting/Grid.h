@@ -0,0 +1,120 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <memory_resource>
+#include <vector>
+#include "DataStructures.h"
+#include "PointCloud.h"
+
+//Topology state of a grid point, its position and normal live in Grid::cloud_ at the same grid index
+struct MeshPoint {
+    uint32_t index = 0;
+    bool used = false;
+    //Active front edges starting or ending at the point
+    uint32_t frontEdges = 0;
+};
+
+//Grid indices of the points around a query point, allocated from the run's memory resource
+using Neighborhood = std::pmr::vector<uint32_t>;
+
+//Interleaves the low 21 bits of each cell coordinate, x in the lowest bit
+inline uint64_t MortonCode(const std::array<int, 3>& index) {
+    uint64_t code = 0;
+    for (auto axis = 0; axis < 3; axis++) {
+        uint64_t bits = static_cast<uint32_t>(index[axis]) & 0x1fffff;
+        bits = (bits | bits << 32) & 0x1f00000000ffffull;
+        bits = (bits | bits << 16) & 0x1f0000ff0000ffull;
+        bits = (bits | bits << 8) & 0x100f00f00f00f00full;
+        bits = (bits | bits << 4) & 0x10c30c30c30c30c3ull;
+        bits = (bits | bits << 2) & 0x1249249249249249ull;
+        code |= bits << axis;
+    }
+    return code;
+}
+
+//Bounds of a non-empty cloud, computed over threads chunks in parallel
+CloudBounds ComputeBounds(const PointCloudView& cloud, size_t threads);
+
+//Contiguous run [first, last) of grid indices belonging to one cell
+struct CellRange {
+    uint32_t first;
+    uint32_t last;
+
+    size_t size() const { return last - first; }
+};
+
+//Uniform grid with a cell edge of two ball radii.
+//All points live in one array sorted by cell, points of a cell keep their input order. Positions and normals are
+//kept in cell order as well, in cloud_, so neighborhood scans read contiguous coordinate arrays.
+//Cells are stored in linear z-y-x order by default: linear cell c owns points_[cell_offsets_[c], cell_offsets_[c + 1]).
+//In Morton order the occupied cells follow the Morton curve instead, so cells near each other in space are mostly
+//near each other in the array as well. cell_slots_ then maps linear cell c to its slot s, which owns
+//points_[cell_offsets_[s], cell_offsets_[s + 1]). Empty cells share the last slot, which holds no points.
+struct Grid {
+    using CellIndex = std::array<int, 3>;
+
+    Grid(const PointCloudView& cloud, float radius, size_t threads = 0, bool mortonOrder = false);
+
+    //Cells per axis of a grid with the given cell edge over bounds, throws if there would be too many cells to index
+    static CellIndex Dimensions(const CloudBounds& bounds, float cellSize);
+
+    //Cell of point in a grid with the given corner, cell edge and dimensions, points outside go to the border cells
+    static CellIndex GetCellIndex(const GeneratedPoint& point, const GeneratedPoint& lower, float cellSize, const CellIndex& dims);
+
+    CellIndex GetCellIndex(const GeneratedPoint& point) const { return GetCellIndex(point, lower_, cell_size_, dims_); }
+
+    size_t GetLinearIndex(const CellIndex& index) const {
+        return (static_cast<size_t>(index[2]) * dims_[1] + index[1]) * dims_[0] + index[0];
+    }
+
+    CellIndex GetCellIndexOf(size_t linearIndex) const {
+        const auto layer = static_cast<size_t>(dims_[0]) * dims_[1];
+        return { static_cast<int>(linearIndex % dims_[0]),
+                 static_cast<int>(linearIndex % layer / dims_[0]),
+                 static_cast<int>(linearIndex / layer) };
+    }
+
+    size_t CellCount() const { return static_cast<size_t>(dims_[0]) * dims_[1] * dims_[2]; }
+
+    //Cells to scan on each side of the center one to cover two radii of the given ball
+    int Reach(float radius) const {
+        return std::max(1, static_cast<int>(std::ceil(radius * 2 / cell_size_)));
+    }
+
+    CellRange GetCell(size_t linearIndex) const {
+        const size_t slot = cell_slots_.empty() ? linearIndex : cell_slots_[linearIndex];
+        return { cell_offsets_[slot], cell_offsets_[slot + 1] };
+    }
+
+    CellRange GetCell(const CellIndex& index) const { return GetCell(GetLinearIndex(index)); }
+
+    GeneratedPoint Position(uint32_t point) const { return cloud_.Position(point); }
+
+    GeneratedPoint Normal(uint32_t point) const { return cloud_.Normal(point); }
+
+    //Fills result with the grid indices of the points closer than two ball radii to point, skipping the given ones.
+    //Balls larger than the one the grid was built for scan more cells around the center one.
+    //result is cleared first and keeps its capacity, so one buffer can serve every query of a run.
+    void SphericalNeighborhood(const GeneratedPoint& point, float radius, std::initializer_list<uint32_t> ignore, Neighborhood& result) const;
+
+    //True when no point but the ones with the given grid indices lies inside the ball around center.
+    //Only visits the cells the ball overlaps and stops at the first point found inside.
+    bool BallIsEmpty(const GeneratedPoint& center, float radius, std::initializer_list<uint32_t> ignore) const;
+
+    GeneratedPoint lower_;
+    GeneratedPoint upper_;
+    float cell_size_;
+    CellIndex dims_;
+    std::vector<MeshPoint> points_;
+    PointCloud cloud_;
+    std::vector<uint32_t> cell_offsets_;
+    //Slot of every linear cell in Morton order, empty in linear order
+    std::vector<uint32_t> cell_slots_;
+};
+
+#endif // GRID_H
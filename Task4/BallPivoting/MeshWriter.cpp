@@ -0,0 +1,273 @@
+#include "MeshWriter.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+//Bytes collected before each write
+constexpr size_t WriteBufferSize = size_t{4} << 20;
+
+constexpr size_t StlHeaderSize = 80;
+
+bool HostIsLittleEndian() {
+    const uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+template <typename T>
+void AppendLittleEndian(std::string& buffer, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    if (!HostIsLittleEndian()) std::reverse(bytes, bytes + sizeof(T));
+    buffer.append(bytes, sizeof(T));
+}
+
+template <typename T>
+void AppendText(std::string& buffer, T value, char separator) {
+    char text[32];
+    const auto result = std::to_chars(text, text + sizeof(text), value);
+    buffer.append(text, result.ptr);
+    buffer.push_back(separator);
+}
+
+//Unit normal of the counter-clockwise face a, b, c, zero for degenerate faces
+GeneratedPoint FaceNormal(const GeneratedPoint& a, const GeneratedPoint& b, const GeneratedPoint& c) {
+    const auto u = b - a, v = c - a;
+    GeneratedPoint normal{u.y * v.z - u.z * v.y, u.z * v.x - u.x * v.z, u.x * v.y - u.y * v.x};
+    const float length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+    if (length > 0)
+        normal = {normal.x / length, normal.y / length, normal.z / length};
+    else
+        normal = {0, 0, 0};
+    return normal;
+}
+
+void AppendVertexRecord(std::string& buffer, const GeneratedPoint& point) {
+    for (const float value : {point.x, point.y, point.z, point.n_x, point.n_y, point.n_z})
+        AppendLittleEndian(buffer, value);
+}
+
+}
+
+MeshFormat MeshFormatFromFileName(const std::string& fileName) {
+    const auto dot = fileName.find_last_of('.');
+    std::string extension = dot == std::string::npos ? std::string() : fileName.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (extension == "obj") return MeshFormat::obj;
+    if (extension == "stl") return MeshFormat::stl;
+    if (extension == "ply") return MeshFormat::ply;
+    throw std::invalid_argument("unknown mesh format of " + fileName + ", expected .obj, .stl or .ply");
+}
+
+MeshWriter::MeshWriter(const std::string& fileName, MeshFormat format, const PointCloudView& vertices)
+    : fileName_(fileName), format_(format), indexed_(true), vertices_(vertices) {
+    if (format_ == MeshFormat::ply && vertices_.size() > static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+        throw std::runtime_error("too many vertices for the int indices of a PLY face");
+    Open();
+}
+
+MeshWriter::MeshWriter(const std::string& fileName, MeshFormat format)
+    : fileName_(fileName), format_(format), indexed_(false) {
+    Open();
+}
+
+MeshWriter::~MeshWriter() {
+    if (spoolName_.empty() || finished_) return;
+    out_.close();
+    std::remove(spoolName_.c_str());
+}
+
+//PLY bodies go to a spool file next to the target until Finish() knows the counts of the header
+void MeshWriter::Open() {
+    if (format_ == MeshFormat::ply)
+        spoolName_ = fileName_ + ".part";
+    const auto& name = spoolName_.empty() ? fileName_ : spoolName_;
+    out_.open(name, std::ios::binary | std::ios::trunc);
+    if (!out_) throw std::runtime_error("cannot open " + name);
+    buffer_.reserve(WriteBufferSize + 256);
+    WriteHeader();
+}
+
+//The header starts the buffer before anything is flushed, so placeholder positions in the buffer are file positions
+void MeshWriter::WriteHeader() {
+    switch (format_) {
+    case MeshFormat::obj:
+        //Indexed meshes list their vertices up front, soups write the corners of each face before it
+        for (size_t i = 0; i < vertices_.size(); ++i) {
+            buffer_.append("v ");
+            AppendText(buffer_, vertices_.x()[i], ' ');
+            AppendText(buffer_, vertices_.y()[i], ' ');
+            AppendText(buffer_, vertices_.z()[i], '\n');
+            FlushIfFull();
+        }
+        break;
+
+    case MeshFormat::stl: {
+        std::string header = "binary STL written by BallPivoting";
+        header.resize(StlHeaderSize, '\0');
+        buffer_.append(header);
+        triangleCountPosition_ = static_cast<std::streamoff>(buffer_.size());
+        AppendLittleEndian(buffer_, uint32_t{0});
+        break;
+    }
+
+    case MeshFormat::ply:
+        //Written by Finish() ahead of the spooled body
+        break;
+    }
+}
+
+void MeshWriter::WritePlyHeader(uint64_t vertexCount) {
+    buffer_.append("ply\nformat binary_little_endian 1.0\nelement vertex ");
+    buffer_.append(std::to_string(vertexCount));
+    buffer_.append("\nproperty float x\nproperty float y\nproperty float z\n"
+                   "property float nx\nproperty float ny\nproperty float nz\n"
+                   "element face ");
+    buffer_.append(std::to_string(triangles_));
+    buffer_.append("\nproperty list uchar int vertex_indices\nend_header\n");
+}
+
+void MeshWriter::Write(const IndexedTriangle* triangles, size_t count) {
+    if (!indexed_) throw std::logic_error("indexed triangles written to a triangle soup");
+    for (size_t i = 0; i < count; ++i) {
+        const auto& triangle = triangles[i];
+        for (const auto index : triangle)
+            if (index >= vertices_.size()) throw std::out_of_range("triangle indexes a missing vertex");
+        WriteFace(vertices_.Position(triangle[0]), vertices_.Position(triangle[1]), vertices_.Position(triangle[2]), triangle);
+    }
+}
+
+void MeshWriter::Write(const Triangle* triangles, size_t count) {
+    if (indexed_) throw std::logic_error("a triangle soup written to an indexed mesh");
+    for (size_t i = 0; i < count; ++i) {
+        const auto& triangle = triangles[i];
+        if (triangles_ >= static_cast<uint64_t>(std::numeric_limits<int32_t>::max() / 3))
+            throw std::runtime_error("too many triangles for the int indices of a soup");
+        const auto first = static_cast<uint32_t>(3 * triangles_);
+
+        if (format_ == MeshFormat::obj) {
+            for (const auto& point : triangle) {
+                buffer_.append("v ");
+                AppendText(buffer_, point.x, ' ');
+                AppendText(buffer_, point.y, ' ');
+                AppendText(buffer_, point.z, '\n');
+            }
+        } else if (format_ == MeshFormat::ply) {
+            //The spool of a soup holds its vertices, the faces number them in order and are written by Finish()
+            for (const auto& point : triangle)
+                AppendVertexRecord(buffer_, point);
+            triangles_++;
+            FlushIfFull();
+            continue;
+        }
+        WriteFace(triangle[0], triangle[1], triangle[2], {first, first + 1, first + 2});
+    }
+}
+
+void MeshWriter::WriteFace(const GeneratedPoint& a, const GeneratedPoint& b, const GeneratedPoint& c, const IndexedTriangle& indices) {
+    switch (format_) {
+    case MeshFormat::obj:
+        buffer_.append("f ");
+        AppendText(buffer_, indices[0] + 1, ' ');
+        AppendText(buffer_, indices[1] + 1, ' ');
+        AppendText(buffer_, indices[2] + 1, '\n');
+        break;
+
+    case MeshFormat::stl: {
+        if (triangles_ == std::numeric_limits<uint32_t>::max())
+            throw std::runtime_error("too many triangles for a binary STL file");
+        const auto normal = FaceNormal(a, b, c);
+        for (const auto& point : {normal, a, b, c}) {
+            AppendLittleEndian(buffer_, point.x);
+            AppendLittleEndian(buffer_, point.y);
+            AppendLittleEndian(buffer_, point.z);
+        }
+        AppendLittleEndian(buffer_, uint16_t{0});
+        break;
+    }
+
+    case MeshFormat::ply:
+        AppendLittleEndian(buffer_, uint8_t{3});
+        for (const auto index : indices)
+            AppendLittleEndian(buffer_, static_cast<int32_t>(index));
+        break;
+    }
+    triangles_++;
+    FlushIfFull();
+}
+
+void MeshWriter::Finish() {
+    if (finished_) return;
+
+    Flush();
+
+    if (format_ == MeshFormat::stl) {
+        std::string count;
+        AppendLittleEndian(count, static_cast<uint32_t>(triangles_));
+        Patch(triangleCountPosition_, count);
+    } else if (format_ == MeshFormat::ply) {
+        FinishPly();
+    }
+
+    out_.close();
+    if (!out_) throw std::runtime_error("failed writing " + fileName_);
+    //Only now, a failure above leaves the spool to the destructor
+    finished_ = true;
+    if (!spoolName_.empty()) std::remove(spoolName_.c_str());
+}
+
+//Writes the header with the final counts to the target, then the vertices of an indexed mesh, the spooled body
+//and the faces of a soup
+void MeshWriter::FinishPly() {
+    out_.close();
+    if (!out_) throw std::runtime_error("failed writing " + spoolName_);
+    out_.open(fileName_, std::ios::binary | std::ios::trunc);
+    if (!out_) throw std::runtime_error("cannot open " + fileName_);
+
+    WritePlyHeader(indexed_ ? vertices_.size() : 3 * triangles_);
+    for (size_t i = 0; i < vertices_.size(); ++i) {
+        AppendVertexRecord(buffer_, vertices_[i]);
+        FlushIfFull();
+    }
+    Flush();
+
+    std::ifstream spool(spoolName_, std::ios::binary);
+    if (!spool) throw std::runtime_error("cannot open " + spoolName_);
+    if (spool.peek() != std::ifstream::traits_type::eof())
+        out_ << spool.rdbuf();
+    if (!out_) throw std::runtime_error("failed writing " + fileName_);
+
+    if (!indexed_) {
+        for (uint64_t i = 0; i < triangles_; ++i) {
+            AppendLittleEndian(buffer_, uint8_t{3});
+            for (uint64_t corner = 0; corner < 3; ++corner)
+                AppendLittleEndian(buffer_, static_cast<int32_t>(3 * i + corner));
+            FlushIfFull();
+        }
+    }
+    Flush();
+}
+
+void MeshWriter::FlushIfFull() {
+    if (buffer_.size() >= WriteBufferSize) Flush();
+}
+
+void MeshWriter::Flush() {
+    out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+    if (!out_) throw std::runtime_error("failed writing " + fileName_);
+}
+
+void MeshWriter::Patch(std::streamoff position, const std::string& text) {
+    out_.seekp(position);
+    out_.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
@@ -0,0 +1,74 @@
+#ifndef MESHWRITER_H
+#define MESHWRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include "BallPivotingAlgorithm.h"
+#include "PointCloud.h"
+
+enum class MeshFormat {
+    obj,
+    //Binary STL
+    stl,
+    //Binary little endian PLY
+    ply
+};
+
+//Format named by the extension of fileName, throws std::invalid_argument for other extensions
+MeshFormat MeshFormatFromFileName(const std::string& fileName);
+
+//Writes a mesh whose triangles arrive in chunks, so a mesh never has to be held in memory twice to be saved.
+//Values are formatted into a large buffer that is written out whenever it fills up, text uses std::to_chars.
+//The STL triangle count is patched in by Finish(). PLY headers need exact counts first, so the PLY body is spooled
+//to fileName + ".part" and Finish() writes the header and copies the body behind it. A writer destroyed without a
+//successful Finish() leaves an incomplete OBJ or STL file, and removes the spool of a PLY file. Errors throw std::runtime_error.
+class MeshWriter {
+public:
+    //Indexed mesh, the triangles index vertices, which must stay alive until Finish()
+    MeshWriter(const std::string& fileName, MeshFormat format, const PointCloudView& vertices);
+
+    //Triangle soup, every triangle carries its own corners
+    MeshWriter(const std::string& fileName, MeshFormat format);
+
+    ~MeshWriter();
+
+    MeshWriter(const MeshWriter&) = delete;
+    MeshWriter& operator=(const MeshWriter&) = delete;
+
+    //For writers of indexed meshes only
+    void Write(const IndexedTriangle* triangles, size_t count);
+
+    //For writers of triangle soups only
+    void Write(const Triangle* triangles, size_t count);
+
+    void Finish();
+
+    uint64_t TrianglesWritten() const { return triangles_; }
+
+private:
+    void Open();
+    void WriteHeader();
+    void WritePlyHeader(uint64_t vertexCount);
+    void FinishPly();
+    void WriteFace(const GeneratedPoint& a, const GeneratedPoint& b, const GeneratedPoint& c, const IndexedTriangle& indices);
+    void FlushIfFull();
+    void Flush();
+    void Patch(std::streamoff position, const std::string& text);
+
+    std::string fileName_;
+    std::string spoolName_;
+    MeshFormat format_;
+    bool indexed_;
+    PointCloudView vertices_;
+    std::ofstream out_;
+    std::string buffer_;
+    uint64_t triangles_ = 0;
+    bool finished_ = false;
+
+    //File position of the STL triangle count
+    std::streamoff triangleCountPosition_ = -1;
+};
+
+#endif // MESHWRITER_H
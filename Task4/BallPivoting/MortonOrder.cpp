@@ -0,0 +1,89 @@
+#include "MortonOrder.h"
+#include <algorithm>
+#include <array>
+#include "Grid.h"
+#include "Parallel.h"
+
+namespace {
+
+//Key bits sorted per pass
+constexpr unsigned RadixBits = 8;
+constexpr size_t RadixBuckets = size_t{1} << RadixBits;
+
+//Bits of each cell coordinate MortonCode interleaves
+constexpr unsigned MortonAxisBits = 21;
+
+//Stable sort of order by keys, both arrays are permuted. Every pass counts the digits of each thread's chunk,
+//then scatters the chunk behind the chunks before it, so equal keys keep their relative order.
+void RadixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& order, unsigned keyBits, size_t threads) {
+    std::vector<uint64_t> keyBuffer(keys.size());
+    std::vector<uint32_t> orderBuffer(order.size());
+    std::vector<std::array<uint32_t, RadixBuckets>> cursors(threads);
+
+    for (unsigned shift = 0; shift < keyBits; shift += RadixBits) {
+        const auto digit = [shift](uint64_t key) { return static_cast<size_t>(key >> shift) & (RadixBuckets - 1); };
+
+        for (auto& counts : cursors)
+            counts.fill(0);
+        ParallelForChunks(keys.size(), threads, [&](size_t t, size_t begin, size_t end) {
+            auto& counts = cursors[t];
+            for (size_t i = begin; i < end; ++i)
+                counts[digit(keys[i])]++;
+        });
+
+        uint32_t offset = 0;
+        for (size_t bucket = 0; bucket < RadixBuckets; ++bucket) {
+            for (auto& counts : cursors) {
+                const auto count = counts[bucket];
+                counts[bucket] = offset;
+                offset += count;
+            }
+        }
+
+        ParallelForChunks(keys.size(), threads, [&](size_t t, size_t begin, size_t end) {
+            auto& cursor = cursors[t];
+            for (size_t i = begin; i < end; ++i) {
+                const auto target = cursor[digit(keys[i])]++;
+                keyBuffer[target] = keys[i];
+                orderBuffer[target] = order[i];
+            }
+        });
+
+        keys.swap(keyBuffer);
+        order.swap(orderBuffer);
+    }
+}
+
+}
+
+void SortCellsByMortonCode(std::vector<uint32_t>& cells, const std::array<int, 3>& dims, size_t threads) {
+    if (cells.empty())
+        return;
+
+    threads = ResolveThreadCount(threads);
+
+    //Cell coordinates wider than MortonCode takes are shifted down, neighbouring cells then share a code
+    //and keep their given order among each other
+    const auto widest = static_cast<unsigned>(*std::max_element(dims.begin(), dims.end()));
+    unsigned axisBits = 0;
+    while ((widest - 1) >> axisBits)
+        axisBits++;
+    const unsigned coarsening = axisBits > MortonAxisBits ? axisBits - MortonAxisBits : 0;
+    const unsigned keyBits = 3 * (axisBits - coarsening);
+
+    const auto layer = static_cast<size_t>(dims[0]) * dims[1];
+    std::vector<uint64_t> keys(cells.size());
+    ParallelForChunks(cells.size(), threads, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const size_t cell = cells[i];
+            std::array<int, 3> index{ static_cast<int>(cell % dims[0]),
+                                      static_cast<int>(cell % layer / dims[0]),
+                                      static_cast<int>(cell / layer) };
+            for (auto& coordinate : index)
+                coordinate >>= coarsening;
+            keys[i] = MortonCode(index);
+        }
+    });
+
+    RadixSort(keys, cells, keyBits, threads);
+}
@@ -0,0 +1,15 @@
+#ifndef MORTONORDER_H
+#define MORTONORDER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//Sorts the linear indices of cells of a grid with the given dimensions along the Morton curve through their cell
+//coordinates, cells of equal code keep their given order. Coordinates wider than the 21 bits a code holds are shifted
+//down first, so neighbouring cells of very long axes share a code. Sorted with a parallel least significant digit
+//radix sort.
+void SortCellsByMortonCode(std::vector<uint32_t>& cells, const std::array<int, 3>& dims, size_t threads = 0);
+
+#endif // MORTONORDER_H
@@ -0,0 +1,66 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Number of worker threads to use when the caller asked for 0 (automatic)
+inline size_t ResolveThreadCount(size_t requested) {
+    if (requested != 0) return requested;
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+//Splits [0, count) into at most threads contiguous chunks and runs body(chunkIndex, begin, end) for each,
+//the calling thread takes the first chunk. Chunk boundaries only depend on count and threads.
+//If a chunk throws, the other chunks still finish and the first exception is rethrown on the calling thread.
+template <typename Body>
+void ParallelForChunks(size_t count, size_t threads, Body&& body) {
+    threads = std::max<size_t>(1, std::min(threads, count));
+    if (threads == 1) {
+        body(size_t{0}, size_t{0}, count);
+        return;
+    }
+
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    const auto keepFirst = [&]() {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) error = std::current_exception();
+    };
+    const auto run = [&](size_t t, size_t begin, size_t end) {
+        try {
+            body(t, begin, end);
+        } catch (...) {
+            keepFirst();
+        }
+    };
+
+    const size_t chunk = (count + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    bool started = true;
+    try {
+        workers.reserve(threads - 1);
+        for (size_t t = 1; t < threads; ++t) {
+            const size_t begin = std::min(count, t * chunk);
+            const size_t end = std::min(count, begin + chunk);
+            workers.emplace_back(run, t, begin, end);
+        }
+    } catch (...) {
+        //No thread to spare, the chunks that did start are still joined below
+        keepFirst();
+        started = false;
+    }
+    if (started)
+        run(size_t{0}, size_t{0}, std::min(count, chunk));
+
+    for (auto& worker : workers)
+        worker.join();
+    if (error)
+        std::rethrow_exception(error);
+}
+
+#endif // PARALLEL_H
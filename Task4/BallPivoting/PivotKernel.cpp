@@ -0,0 +1,117 @@
+#include "PivotKernel.h"
+#include <cmath>
+#include "PivotKernelImpl.h"
+
+#ifdef BALLPIVOTING_X86_SIMD
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+#endif
+
+namespace {
+
+struct ScalarLanes {
+    static constexpr size_t width = 1;
+    using Value = float;
+    using Mask = bool;
+
+    static Value Broadcast(float value) { return value; }
+    static Value Load(const float* source) { return *source; }
+    static void Store(float* target, Value value) { *target = value; }
+    static Value Sqrt(Value value) { return std::sqrt(value); }
+    static Mask Less(Value lhs, Value rhs) { return lhs < rhs; }
+    static Mask GreaterEqual(Value lhs, Value rhs) { return lhs >= rhs; }
+    static Mask AndNot(Mask mask, Mask excluded) { return mask && !excluded; }
+    static Value Select(Mask mask, Value ifSet, Value ifClear) { return mask ? ifSet : ifClear; }
+};
+
+#ifdef BALLPIVOTING_X86_SIMD
+
+struct Sse2Value {
+    __m128 v;
+};
+
+Sse2Value operator+(Sse2Value lhs, Sse2Value rhs) { return { _mm_add_ps(lhs.v, rhs.v) }; }
+Sse2Value operator-(Sse2Value lhs, Sse2Value rhs) { return { _mm_sub_ps(lhs.v, rhs.v) }; }
+Sse2Value operator*(Sse2Value lhs, Sse2Value rhs) { return { _mm_mul_ps(lhs.v, rhs.v) }; }
+Sse2Value operator/(Sse2Value lhs, Sse2Value rhs) { return { _mm_div_ps(lhs.v, rhs.v) }; }
+
+struct Sse2Lanes {
+    static constexpr size_t width = 4;
+    using Value = Sse2Value;
+    using Mask = __m128;
+
+    static Value Broadcast(float value) { return { _mm_set1_ps(value) }; }
+    static Value Load(const float* source) { return { _mm_load_ps(source) }; }
+    static void Store(float* target, Value value) { _mm_store_ps(target, value.v); }
+    static Value Sqrt(Value value) { return { _mm_sqrt_ps(value.v) }; }
+    static Mask Less(Value lhs, Value rhs) { return _mm_cmplt_ps(lhs.v, rhs.v); }
+    static Mask GreaterEqual(Value lhs, Value rhs) { return _mm_cmpge_ps(lhs.v, rhs.v); }
+    static Mask AndNot(Mask mask, Mask excluded) { return _mm_andnot_ps(excluded, mask); }
+    static Value Select(Mask mask, Value ifSet, Value ifClear) {
+        return { _mm_or_ps(_mm_and_ps(mask, ifSet.v), _mm_andnot_ps(mask, ifClear.v)) };
+    }
+};
+
+bool CpuHasAvx2() {
+#if defined(__GNUC__)
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    //The OS must save the YMM registers as well
+    __cpuid(info, 1);
+    const bool osSavesAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+    if (!osSavesAvx) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+#endif
+
+PivotKernel DetectPivotKernel() {
+#ifdef BALLPIVOTING_X86_SIMD
+    return CpuHasAvx2() ? PivotKernel::avx2 : PivotKernel::sse2;
+#else
+    return PivotKernel::scalar;
+#endif
+}
+
+}
+
+PivotKernel ActivePivotKernel() {
+    static const PivotKernel kernel = DetectPivotKernel();
+    return kernel;
+}
+
+void EvaluatePivotCandidates(const PivotFrame& frame, const PointCloud& candidates, PivotScores& scores) {
+    const size_t count = candidates.size();
+    for (auto* array : {&scores.angle, &scores.x, &scores.y, &scores.z})
+        array->resize(count);
+
+    const PivotInput input{ candidates.x(), candidates.y(), candidates.z(),
+                            candidates.n_x(), candidates.n_y(), candidates.n_z() };
+    const PivotOutput output{ scores.angle.data(), scores.x.data(), scores.y.data(), scores.z.data() };
+
+    size_t done = 0;
+#ifdef BALLPIVOTING_X86_SIMD
+    switch (ActivePivotKernel()) {
+    case PivotKernel::avx2:
+        done = EvaluatePivotCandidatesAvx2(frame, input, output, count);
+        break;
+    case PivotKernel::sse2:
+        done = count - count % Sse2Lanes::width;
+        EvaluatePivotLanes<Sse2Lanes>(frame, input, output, 0, done);
+        break;
+    case PivotKernel::scalar:
+        break;
+    }
+#endif
+    EvaluatePivotLanes<ScalarLanes>(frame, input, output, done, count);
+}
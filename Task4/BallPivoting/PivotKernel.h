@@ -0,0 +1,66 @@
+#ifndef PIVOTKERNEL_H
+#define PIVOTKERNEL_H
+
+#include <cstddef>
+#include "DataStructures.h"
+#include "PointCloud.h"
+
+//SSE2 and AVX2 kernels are built on x86 unless BALLPIVOTING_NO_SIMD is defined, AVX2 is only used where the CPU has it
+#if !defined(BALLPIVOTING_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define BALLPIVOTING_X86_SIMD
+#endif
+
+enum class PivotKernel {
+    scalar,
+    sse2,
+    avx2
+};
+
+//Edge a -> b the ball pivots around, shared by every candidate of one pivot
+struct PivotFrame {
+    GeneratedPoint a;
+    GeneratedPoint b;
+    GeneratedPoint m;
+    GeneratedPoint oldCenterVec;
+    float radius;
+};
+
+//Per candidate results, the ball center touching a, b and the candidate and the pseudo-angle the ball turns to reach it.
+//Candidates the ball cannot rest on get an infinite angle.
+struct PivotScores {
+    PointCloud::Array angle;
+    PointCloud::Array x;
+    PointCloud::Array y;
+    PointCloud::Array z;
+};
+
+//Raw views of a batch, what the kernels of every instruction set take
+struct PivotInput {
+    const float* x;
+    const float* y;
+    const float* z;
+    const float* n_x;
+    const float* n_y;
+    const float* n_z;
+};
+
+struct PivotOutput {
+    float* angle;
+    float* x;
+    float* y;
+    float* z;
+};
+
+//Instruction set picked for this CPU on first use
+PivotKernel ActivePivotKernel();
+
+//Scores every candidate of the batch at the vector width of the active kernel, all kernels give bitwise equal results.
+//The pseudo-angle grows monotonically with the pivot angle: 1 - cos on the first half turn, plus 2 on the second.
+void EvaluatePivotCandidates(const PivotFrame& frame, const PointCloud& candidates, PivotScores& scores);
+
+#ifdef BALLPIVOTING_X86_SIMD
+//Scores the candidates in blocks of eight and returns how many it scored, the caller finishes the tail
+size_t EvaluatePivotCandidatesAvx2(const PivotFrame& frame, const PivotInput& input, const PivotOutput& output, size_t count);
+#endif
+
+#endif // PIVOTKERNEL_H
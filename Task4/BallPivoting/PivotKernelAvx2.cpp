@@ -0,0 +1,60 @@
+#include "PivotKernel.h"
+
+#ifdef BALLPIVOTING_X86_SIMD
+
+#include <cstddef>
+#include <immintrin.h>
+#include <limits>
+
+//Only the code below is built for AVX2, it runs after ActivePivotKernel() found the instructions on the CPU.
+//Everything it calls is defined here, so no inline function shared with other files is compiled for AVX2.
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+#include "PivotKernelImpl.h"
+
+namespace {
+
+struct Avx2Value {
+    __m256 v;
+};
+
+Avx2Value operator+(Avx2Value lhs, Avx2Value rhs) { return { _mm256_add_ps(lhs.v, rhs.v) }; }
+Avx2Value operator-(Avx2Value lhs, Avx2Value rhs) { return { _mm256_sub_ps(lhs.v, rhs.v) }; }
+Avx2Value operator*(Avx2Value lhs, Avx2Value rhs) { return { _mm256_mul_ps(lhs.v, rhs.v) }; }
+Avx2Value operator/(Avx2Value lhs, Avx2Value rhs) { return { _mm256_div_ps(lhs.v, rhs.v) }; }
+
+struct Avx2Lanes {
+    static constexpr size_t width = 8;
+    using Value = Avx2Value;
+    using Mask = __m256;
+
+    static Value Broadcast(float value) { return { _mm256_set1_ps(value) }; }
+    static Value Load(const float* source) { return { _mm256_load_ps(source) }; }
+    static void Store(float* target, Value value) { _mm256_store_ps(target, value.v); }
+    static Value Sqrt(Value value) { return { _mm256_sqrt_ps(value.v) }; }
+    static Mask Less(Value lhs, Value rhs) { return _mm256_cmp_ps(lhs.v, rhs.v, _CMP_LT_OQ); }
+    static Mask GreaterEqual(Value lhs, Value rhs) { return _mm256_cmp_ps(lhs.v, rhs.v, _CMP_GE_OQ); }
+    static Mask AndNot(Mask mask, Mask excluded) { return _mm256_andnot_ps(excluded, mask); }
+    static Value Select(Mask mask, Value ifSet, Value ifClear) { return { _mm256_blendv_ps(ifClear.v, ifSet.v, mask) }; }
+};
+
+}
+
+size_t EvaluatePivotCandidatesAvx2(const PivotFrame& frame, const PivotInput& input, const PivotOutput& output, size_t count) {
+    const size_t blocks = count - count % Avx2Lanes::width;
+    EvaluatePivotLanes<Avx2Lanes>(frame, input, output, 0, blocks);
+    return blocks;
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif
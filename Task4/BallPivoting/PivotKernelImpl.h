@@ -0,0 +1,81 @@
+#ifndef PIVOTKERNELIMPL_H
+#define PIVOTKERNELIMPL_H
+
+#include <cstddef>
+#include <limits>
+#include "PivotKernel.h"
+
+//Pivot candidate scoring written once over a lane type. Lanes provides Value with + - * /, Broadcast, Load, Store,
+//Sqrt, ordered Less and GreaterEqual masks, AndNot(m, n) = m && !n and Select(mask, ifSet, ifClear).
+//Operations follow the scalar geometry of ComputeBallCenter and Triangle::GetNormUnitVector one for one and nothing
+//is fused, so every lane width rounds exactly like the scalar code.
+template <typename Lanes>
+void EvaluatePivotLanes(const PivotFrame& frame, const PivotInput& in, const PivotOutput& out, size_t begin, size_t end) {
+    using Value = typename Lanes::Value;
+
+    //Candidate independent terms, computed in scalar once
+    const float abX = frame.a.x - frame.b.x, abY = frame.a.y - frame.b.y, abZ = frame.a.z - frame.b.z;
+    const float abDot = abX * abX + abY * abY + abZ * abZ;
+
+    const Value ax = Lanes::Broadcast(frame.a.x), ay = Lanes::Broadcast(frame.a.y), az = Lanes::Broadcast(frame.a.z);
+    const Value bx = Lanes::Broadcast(frame.b.x), by = Lanes::Broadcast(frame.b.y), bz = Lanes::Broadcast(frame.b.z);
+    const Value mx = Lanes::Broadcast(frame.m.x), my = Lanes::Broadcast(frame.m.y), mz = Lanes::Broadcast(frame.m.z);
+    const Value ox = Lanes::Broadcast(frame.oldCenterVec.x),
+                oy = Lanes::Broadcast(frame.oldCenterVec.y),
+                oz = Lanes::Broadcast(frame.oldCenterVec.z);
+    const Value abx = Lanes::Broadcast(abX), aby = Lanes::Broadcast(abY), abz = Lanes::Broadcast(abZ);
+    const Value abAb = Lanes::Broadcast(abDot);
+    const Value squaredRadius = Lanes::Broadcast(frame.radius * frame.radius);
+    const Value zero = Lanes::Broadcast(0.0f), one = Lanes::Broadcast(1.0f), two = Lanes::Broadcast(2.0f);
+    const Value rejected = Lanes::Broadcast(std::numeric_limits<float>::infinity());
+
+    for (size_t i = begin; i < end; i += Lanes::width) {
+        const Value px = Lanes::Load(in.x + i), py = Lanes::Load(in.y + i), pz = Lanes::Load(in.z + i);
+
+        //Unit normal of the face (b, a, p)
+        const Value x1 = bx - ax, y1 = by - ay, z1 = bz - az;
+        const Value x2 = bx - px, y2 = by - py, z2 = bz - pz;
+        const Value xNorm = y1 * z2 - z1 * y2,
+                    yNorm = z1 * x2 - x1 * z2,
+                    zNorm = x1 * y2 - y1 * x2;
+        const Value magnitude = Lanes::Sqrt(xNorm * xNorm + yNorm * yNorm + zNorm * zNorm);
+        const Value ux = xNorm / magnitude, uy = yNorm / magnitude, uz = zNorm / magnitude;
+
+        const auto facesAway = Lanes::Less(ux * Lanes::Load(in.n_x + i) + uy * Lanes::Load(in.n_y + i) + uz * Lanes::Load(in.n_z + i), zero);
+
+        //Circumcenter of the face and the ball center above it
+        const Value acx = px - bx, acy = py - by, acz = pz - bz;
+        const Value nx = aby * acz - abz * acy,
+                    ny = abz * acx - abx * acz,
+                    nz = abx * acy - aby * acx;
+        const Value acAc = acx * acx + acy * acy + acz * acz;
+        const Value denominator = two * (nx * nx + ny * ny + nz * nz);
+        const Value tx = ((ny * abz - nz * aby) * acAc + (acy * nz - acz * ny) * abAb) / denominator,
+                    ty = ((nz * abx - nx * abz) * acAc + (acz * nx - acx * nz) * abAb) / denominator,
+                    tz = ((nx * aby - ny * abx) * acAc + (acx * ny - acy * nx) * abAb) / denominator;
+        const Value heightSquared = squaredRadius - (tx * tx + ty * ty + tz * tz);
+        const auto fits = Lanes::GreaterEqual(heightSquared, zero);
+        const Value height = Lanes::Sqrt(heightSquared);
+        const Value cx = (bx + tx) + ux * height,
+                    cy = (by + ty) + uy * height,
+                    cz = (bz + tz) + uz * height;
+
+        //Direction from the edge midpoint to the new center, the ball must stay on the front side of the face
+        const Value dx = cx - mx, dy = cy - my, dz = cz - mz;
+        const Value length = Lanes::Sqrt(dx * dx + dy * dy + dz * dz);
+        const Value vx = dx / length, vy = dy / length, vz = dz / length;
+        const auto behindFace = Lanes::Less(vx * ux + vy * uy + vz * uz, zero);
+
+        const Value cosine = ox * vx + oy * vy + oz * vz;
+        const Value side = (vy * oz - vz * oy) * abx + (vz * ox - vx * oz) * aby + (vx * oy - vy * ox) * abz;
+        const Value angle = (one - cosine) + Lanes::Select(Lanes::Less(side, zero), two, zero);
+
+        const auto valid = Lanes::AndNot(Lanes::AndNot(fits, facesAway), behindFace);
+        Lanes::Store(out.angle + i, Lanes::Select(valid, angle, rejected));
+        Lanes::Store(out.x + i, cx);
+        Lanes::Store(out.y + i, cy);
+        Lanes::Store(out.z + i, cz);
+    }
+}
+
+#endif // PIVOTKERNELIMPL_H
@@ -0,0 +1,436 @@
+#include "Ply.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+//Binary vertices read and decoded at once
+constexpr size_t ReadBatch = size_t{1} << 14;
+
+//Bytes collected before each write
+constexpr size_t WriteBufferSize = size_t{1} << 20;
+
+enum class PlyType {
+    int8,
+    uint8,
+    int16,
+    uint16,
+    int32,
+    uint32,
+    float32,
+    float64
+};
+
+struct PlyProperty {
+    std::string name;
+    PlyType type = PlyType::float32;
+    //List properties hold a count of countType followed by that many values of type
+    bool list = false;
+    PlyType countType = PlyType::uint8;
+};
+
+struct PlyElement {
+    std::string name;
+    uint64_t count = 0;
+    std::vector<PlyProperty> properties;
+};
+
+struct PlyHeader {
+    PlyFormat format = PlyFormat::ascii;
+    std::vector<PlyElement> elements;
+};
+
+std::runtime_error PlyError(const std::string& fileName, const std::string& message) {
+    return std::runtime_error(fileName + ": " + message);
+}
+
+bool HostIsLittleEndian() {
+    const uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+//True when values of the format must be byte swapped on this host
+bool NeedsSwap(PlyFormat format) {
+    return format != PlyFormat::ascii && (format == PlyFormat::binaryLittleEndian) != HostIsLittleEndian();
+}
+
+size_t TypeSize(PlyType type) {
+    switch (type) {
+    case PlyType::int8:
+    case PlyType::uint8:
+        return 1;
+    case PlyType::int16:
+    case PlyType::uint16:
+        return 2;
+    case PlyType::int32:
+    case PlyType::uint32:
+    case PlyType::float32:
+        return 4;
+    case PlyType::float64:
+        return 8;
+    }
+    return 0;
+}
+
+PlyType ParseType(const std::string& name, const std::string& fileName) {
+    static const std::array<std::pair<const char*, PlyType>, 16> types{{
+        {"char", PlyType::int8}, {"int8", PlyType::int8},
+        {"uchar", PlyType::uint8}, {"uint8", PlyType::uint8},
+        {"short", PlyType::int16}, {"int16", PlyType::int16},
+        {"ushort", PlyType::uint16}, {"uint16", PlyType::uint16},
+        {"int", PlyType::int32}, {"int32", PlyType::int32},
+        {"uint", PlyType::uint32}, {"uint32", PlyType::uint32},
+        {"float", PlyType::float32}, {"float32", PlyType::float32},
+        {"double", PlyType::float64}, {"float64", PlyType::float64} }};
+    for (const auto& [typeName, type] : types)
+        if (name == typeName) return type;
+    throw PlyError(fileName, "unknown PLY property type " + name);
+}
+
+PlyHeader ReadHeader(std::istream& in, const std::string& fileName) {
+    std::string line;
+    const auto nextLine = [&]() {
+        if (!std::getline(in, line)) throw PlyError(fileName, "unexpected end of the PLY header");
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+    };
+
+    nextLine();
+    if (line != "ply") throw PlyError(fileName, "not a PLY file");
+
+    PlyHeader header;
+    bool hasFormat = false;
+    for (nextLine(); line != "end_header"; nextLine()) {
+        std::istringstream words(line);
+        std::string keyword;
+        words >> keyword;
+        if (keyword == "format") {
+            std::string format;
+            words >> format;
+            if (format == "ascii") header.format = PlyFormat::ascii;
+            else if (format == "binary_little_endian") header.format = PlyFormat::binaryLittleEndian;
+            else if (format == "binary_big_endian") header.format = PlyFormat::binaryBigEndian;
+            else throw PlyError(fileName, "unknown PLY format " + format);
+            hasFormat = true;
+        } else if (keyword == "element") {
+            PlyElement element;
+            words >> element.name >> element.count;
+            if (!words) throw PlyError(fileName, "malformed PLY header line: " + line);
+            header.elements.push_back(std::move(element));
+        } else if (keyword == "property") {
+            if (header.elements.empty()) throw PlyError(fileName, "PLY property outside of an element");
+            std::string type;
+            words >> type;
+            PlyProperty property;
+            if (type == "list") {
+                std::string countType, itemType;
+                words >> countType >> itemType >> property.name;
+                property.list = true;
+                property.countType = ParseType(countType, fileName);
+                property.type = ParseType(itemType, fileName);
+            } else {
+                words >> property.name;
+                property.type = ParseType(type, fileName);
+            }
+            if (!words) throw PlyError(fileName, "malformed PLY header line: " + line);
+            header.elements.back().properties.push_back(std::move(property));
+        } else if (!keyword.empty() && keyword != "comment" && keyword != "obj_info") {
+            throw PlyError(fileName, "unexpected PLY header line: " + line);
+        }
+    }
+
+    if (!hasFormat) throw PlyError(fileName, "the PLY header has no format line");
+    return header;
+}
+
+template <typename T>
+double Load(const char* bytes) {
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return static_cast<double>(value);
+}
+
+//Value of the given type stored at source in file byte order
+double DecodeBinary(const char* source, PlyType type, bool swap) {
+    std::array<char, 8> bytes;
+    const auto size = TypeSize(type);
+    std::memcpy(bytes.data(), source, size);
+    if (swap) std::reverse(bytes.begin(), bytes.begin() + size);
+
+    switch (type) {
+    case PlyType::int8: return Load<int8_t>(bytes.data());
+    case PlyType::uint8: return Load<uint8_t>(bytes.data());
+    case PlyType::int16: return Load<int16_t>(bytes.data());
+    case PlyType::uint16: return Load<uint16_t>(bytes.data());
+    case PlyType::int32: return Load<int32_t>(bytes.data());
+    case PlyType::uint32: return Load<uint32_t>(bytes.data());
+    case PlyType::float32: return Load<float>(bytes.data());
+    case PlyType::float64: return Load<double>(bytes.data());
+    }
+    return 0;
+}
+
+//Next whitespace separated value of an ASCII record
+bool NextAsciiValue(const char*& cursor, const char* end, double& value) {
+    while (cursor != end && (*cursor == ' ' || *cursor == '\t'))
+        ++cursor;
+    const auto [last, error] = std::from_chars(cursor, end, value);
+    if (error != std::errc() || last == cursor) return false;
+    cursor = last;
+    return true;
+}
+
+//Bytes from the read position to the end of the file
+uint64_t BytesLeft(std::istream& in) {
+    const auto position = in.tellg();
+    in.seekg(0, std::ios::end);
+    const auto end = in.tellg();
+    in.seekg(position);
+    if (position < 0 || end < position) return 0;
+    return static_cast<uint64_t>(end - position);
+}
+
+//Length of a list read as value, false unless it is a whole number no larger than limit
+bool ListLength(double value, uint64_t limit, uint64_t& length) {
+    if (!(value >= 0 && value <= static_cast<double>(limit) && value == std::floor(value))) return false;
+    length = static_cast<uint64_t>(value);
+    return true;
+}
+
+void SkipElement(std::istream& in, const PlyElement& element, PlyFormat format, const std::string& fileName) {
+    const auto truncated = [&]() { return PlyError(fileName, "PLY element " + element.name + " is truncated"); };
+
+    if (format == PlyFormat::ascii) {
+        for (uint64_t i = 0; i < element.count; ++i)
+            if (!in.ignore(std::numeric_limits<std::streamsize>::max(), '\n')) throw truncated();
+        return;
+    }
+
+    const bool fixedSize = std::none_of(element.properties.begin(), element.properties.end(),
+                                        [](const PlyProperty& property) { return property.list; });
+    if (fixedSize) {
+        size_t recordSize = 0;
+        for (const auto& property : element.properties)
+            recordSize += TypeSize(property.type);
+        //Checked first, the product of a corrupt count would wrap and skip nowhere or backwards
+        if (recordSize != 0 && element.count > BytesLeft(in) / recordSize) throw truncated();
+        in.ignore(static_cast<std::streamsize>(element.count * recordSize));
+        if (!in) throw truncated();
+        return;
+    }
+
+    const bool swap = NeedsSwap(format);
+    std::array<char, 8> count;
+    //Every record is checked against the bytes it leaves, so no list length can reach past the end of the file
+    uint64_t left = BytesLeft(in);
+    const auto skip = [&](uint64_t bytes) {
+        if (bytes > left) throw truncated();
+        in.ignore(static_cast<std::streamsize>(bytes));
+        if (!in) throw truncated();
+        left -= bytes;
+    };
+    for (uint64_t i = 0; i < element.count; ++i) {
+        for (const auto& property : element.properties) {
+            const auto itemSize = TypeSize(property.type);
+            uint64_t items = 1;
+            if (property.list) {
+                const auto countSize = TypeSize(property.countType);
+                if (countSize > left || !in.read(count.data(), static_cast<std::streamsize>(countSize))) throw truncated();
+                left -= countSize;
+                if (!ListLength(DecodeBinary(count.data(), property.countType, swap), left / itemSize, items))
+                    throw PlyError(fileName, "PLY element " + element.name + " has a list of invalid length");
+            }
+            skip(items * itemSize);
+        }
+    }
+}
+
+//Property positions of the values the cloud keeps, -1 for absent normals
+struct VertexLayout {
+    std::array<int, 6> properties;
+};
+
+VertexLayout FindVertexProperties(const PlyElement& vertex, const std::string& fileName) {
+    const auto find = [&](const char* name, const char* alternative) {
+        for (size_t i = 0; i < vertex.properties.size(); ++i)
+            if (vertex.properties[i].name == name || vertex.properties[i].name == alternative)
+                return static_cast<int>(i);
+        return -1;
+    };
+
+    VertexLayout layout{{ find("x", "x"), find("y", "y"), find("z", "z"),
+                          find("nx", "normal_x"), find("ny", "normal_y"), find("nz", "normal_z") }};
+    for (auto axis = 0; axis < 3; axis++) {
+        if (layout.properties[axis] < 0) throw PlyError(fileName, "PLY vertices have no x, y and z");
+        if (vertex.properties[layout.properties[axis]].list) throw PlyError(fileName, "PLY vertex coordinates are lists");
+    }
+    return layout;
+}
+
+//The cloud grows with the lines read, a count in the header the file cannot hold is never allocated up front
+void ReadAsciiVertices(std::istream& in, const PlyElement& vertex, const VertexLayout& layout, PointCloud& cloud, const std::string& fileName) {
+    //Every value takes at least a digit and a separator
+    const uint64_t shortestRecord = 2 * vertex.properties.size();
+    cloud.reserve(static_cast<size_t>(std::min(vertex.count, BytesLeft(in) / shortestRecord)));
+
+    std::vector<double> values(vertex.properties.size());
+    std::array<float, 6> components;
+    std::string line;
+    for (uint64_t i = 0; i < vertex.count; ++i) {
+        const auto malformed = [&]() { return PlyError(fileName, "malformed PLY vertex " + std::to_string(i)); };
+        if (!std::getline(in, line)) throw PlyError(fileName, "PLY element vertex is truncated");
+
+        const char* cursor = line.data();
+        const char* end = line.data() + line.size();
+        for (size_t p = 0; p < vertex.properties.size(); ++p) {
+            if (!NextAsciiValue(cursor, end, values[p])) throw malformed();
+            if (!vertex.properties[p].list) continue;
+            //The rest of the line holds at most one value per two characters
+            uint64_t items;
+            if (!ListLength(values[p], static_cast<uint64_t>(end - cursor + 1) / 2, items)) throw malformed();
+            double item;
+            for (; items > 0; --items)
+                if (!NextAsciiValue(cursor, end, item)) throw malformed();
+        }
+
+        for (size_t component = 0; component < components.size(); ++component) {
+            const auto property = layout.properties[component];
+            components[component] = property < 0 ? 0.0f : static_cast<float>(values[property]);
+        }
+        cloud.push_back({ components[0], components[1], components[2], components[3], components[4], components[5] });
+    }
+}
+
+void ReadBinaryVertices(std::istream& in, const PlyElement& vertex, const VertexLayout& layout, PlyFormat format,
+                        PointCloud& cloud, const std::string& fileName) {
+    if (std::any_of(vertex.properties.begin(), vertex.properties.end(), [](const PlyProperty& property) { return property.list; }))
+        throw PlyError(fileName, "binary PLY vertices with list properties are not supported");
+
+    std::vector<size_t> offsets;
+    size_t recordSize = 0;
+    for (const auto& property : vertex.properties) {
+        offsets.push_back(recordSize);
+        recordSize += TypeSize(property.type);
+    }
+
+    //Checked before the cloud is sized, so a corrupt count fails here instead of allocating memory for it
+    if (vertex.count > BytesLeft(in) / recordSize)
+        throw PlyError(fileName, "PLY element vertex is truncated: " + std::to_string(vertex.count) + " vertices of " +
+                                 std::to_string(recordSize) + " bytes do not fit in the file");
+    cloud.resize(static_cast<size_t>(vertex.count));
+
+    const bool swap = NeedsSwap(format);
+    std::array<float*, 6> targets{ cloud.x(), cloud.y(), cloud.z(), cloud.n_x(), cloud.n_y(), cloud.n_z() };
+    std::vector<char> batch(ReadBatch * recordSize);
+    for (uint64_t first = 0; first < vertex.count; first += ReadBatch) {
+        const auto count = static_cast<size_t>(std::min<uint64_t>(ReadBatch, vertex.count - first));
+        if (!in.read(batch.data(), static_cast<std::streamsize>(count * recordSize)))
+            throw PlyError(fileName, "PLY element vertex is truncated");
+
+        for (size_t component = 0; component < targets.size(); ++component) {
+            const auto property = layout.properties[component];
+            float* target = targets[component] + first;
+            if (property < 0) {
+                std::fill(target, target + count, 0.0f);
+                continue;
+            }
+            const char* source = batch.data() + offsets[property];
+            const auto type = vertex.properties[property].type;
+            for (size_t i = 0; i < count; ++i, source += recordSize)
+                target[i] = static_cast<float>(DecodeBinary(source, type, swap));
+        }
+    }
+}
+
+template <typename T>
+void AppendBinary(std::string& buffer, T value, bool swap) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    if (swap) std::reverse(bytes, bytes + sizeof(T));
+    buffer.append(bytes, sizeof(T));
+}
+
+//Shortest text that reads back to the same value
+template <typename T>
+void AppendAscii(std::string& buffer, T value, char separator) {
+    char text[32];
+    const auto result = std::to_chars(text, text + sizeof(text), value);
+    buffer.append(text, result.ptr);
+    buffer.push_back(separator);
+}
+
+}
+
+bool IsPlyFile(const std::string& fileName) {
+    std::ifstream in(fileName, std::ios::binary);
+    char magic[4] = {};
+    in.read(magic, sizeof(magic));
+    return in && std::memcmp(magic, "ply", 3) == 0 && (magic[3] == '\n' || magic[3] == '\r');
+}
+
+PointCloud ReadPlyPointCloud(const std::string& fileName) {
+    std::ifstream in(fileName, std::ios::binary);
+    if (!in) throw std::runtime_error("cannot open " + fileName);
+
+    const auto header = ReadHeader(in, fileName);
+    const auto vertex = std::find_if(header.elements.begin(), header.elements.end(),
+                                     [](const PlyElement& element) { return element.name == "vertex"; });
+    if (vertex == header.elements.end()) throw PlyError(fileName, "PLY file has no vertex element");
+
+    for (auto element = header.elements.begin(); element != vertex; ++element)
+        SkipElement(in, *element, header.format, fileName);
+
+    const auto layout = FindVertexProperties(*vertex, fileName);
+    PointCloud cloud;
+    if (header.format == PlyFormat::ascii)
+        ReadAsciiVertices(in, *vertex, layout, cloud, fileName);
+    else
+        ReadBinaryVertices(in, *vertex, layout, header.format, cloud, fileName);
+    return cloud;
+}
+
+void WritePlyPointCloud(const std::string& fileName, const PointCloudView& points, PlyFormat format) {
+    std::ofstream out(fileName, std::ios::binary);
+    if (!out) throw std::runtime_error("cannot open " + fileName);
+
+    static const char* formatNames[] = { "ascii", "binary_little_endian", "binary_big_endian" };
+    out << "ply\n"
+        << "format " << formatNames[static_cast<int>(format)] << " 1.0\n"
+        << "element vertex " << points.size() << "\n"
+        << "property float x\nproperty float y\nproperty float z\n"
+        << "property float nx\nproperty float ny\nproperty float nz\n"
+        << "end_header\n";
+
+    const bool swap = NeedsSwap(format);
+    const std::array<const float*, 6> arrays{ points.x(), points.y(), points.z(), points.n_x(), points.n_y(), points.n_z() };
+    std::string buffer;
+    buffer.reserve(WriteBufferSize + 256);
+    const auto flushIfFull = [&]() {
+        if (buffer.size() < WriteBufferSize) return;
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    };
+
+    for (size_t i = 0; i < points.size(); ++i) {
+        for (size_t component = 0; component < arrays.size(); ++component) {
+            if (format == PlyFormat::ascii)
+                AppendAscii(buffer, arrays[component][i], component + 1 < arrays.size() ? ' ' : '\n');
+            else
+                AppendBinary(buffer, arrays[component][i], swap);
+        }
+        flushIfFull();
+    }
+
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!out) throw std::runtime_error("failed writing " + fileName);
+}
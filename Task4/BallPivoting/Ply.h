@@ -0,0 +1,25 @@
+#ifndef PLY_H
+#define PLY_H
+
+#include <string>
+#include "PointCloud.h"
+
+enum class PlyFormat {
+    ascii,
+    binaryLittleEndian,
+    binaryBigEndian
+};
+
+//True when the file starts with the "ply" magic line
+bool IsPlyFile(const std::string& fileName);
+
+//Reads x, y, z and, when present, nx, ny, nz of the vertex element in any of the three formats, missing normals are 0.
+//The file is streamed: the header is parsed, elements before the vertices are skipped and the vertices are decoded
+//in fixed-size batches into the cloud, so it is never held in memory as a whole.
+//Throws std::runtime_error for malformed or truncated files.
+PointCloud ReadPlyPointCloud(const std::string& fileName);
+
+//Writes the points as a vertex element with x, y, z, nx, ny, nz float properties
+void WritePlyPointCloud(const std::string& fileName, const PointCloudView& points, PlyFormat format = PlyFormat::binaryLittleEndian);
+
+#endif // PLY_H
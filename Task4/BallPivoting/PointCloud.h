@@ -0,0 +1,172 @@
+#ifndef POINTCLOUD_H
+#define POINTCLOUD_H
+
+#include <array>
+#include <cstddef>
+#include <new>
+#include <vector>
+#include "DataStructures.h"
+
+//Allocates arrays on an Alignment boundary so vector loads never straddle it
+template <typename T, size_t Alignment>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) { }
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{Alignment}));
+    }
+
+    void deallocate(T* pointer, size_t) {
+        ::operator delete(pointer, std::align_val_t{Alignment});
+    }
+};
+
+template <typename T, typename U, size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) { return true; }
+
+template <typename T, typename U, size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) { return false; }
+
+//Axis aligned box around a point cloud
+struct CloudBounds {
+    GeneratedPoint lower;
+    GeneratedPoint upper;
+};
+
+//Read-only view of structure-of-arrays points kept elsewhere, such as a PointCloud or a memory mapped file
+class PointCloudView {
+public:
+    PointCloudView() = default;
+
+    PointCloudView(size_t size, const float* x, const float* y, const float* z,
+                   const float* n_x, const float* n_y, const float* n_z)
+        : size_(size), x_(x), y_(y), z_(z), n_x_(n_x), n_y_(n_y), n_z_(n_z) { }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    GeneratedPoint operator[](size_t index) const {
+        return { x_[index], y_[index], z_[index], n_x_[index], n_y_[index], n_z_[index] };
+    }
+
+    GeneratedPoint Position(size_t index) const { return { x_[index], y_[index], z_[index] }; }
+
+    GeneratedPoint Normal(size_t index) const { return { n_x_[index], n_y_[index], n_z_[index] }; }
+
+    std::vector<GeneratedPoint> ToPoints() const {
+        std::vector<GeneratedPoint> points;
+        points.reserve(size_);
+        for (size_t i = 0; i < size_; ++i)
+            points.push_back((*this)[i]);
+        return points;
+    }
+
+    const float* x() const { return x_; }
+    const float* y() const { return y_; }
+    const float* z() const { return z_; }
+    const float* n_x() const { return n_x_; }
+    const float* n_y() const { return n_y_; }
+    const float* n_z() const { return n_z_; }
+
+private:
+    size_t size_ = 0;
+    const float* x_ = nullptr;
+    const float* y_ = nullptr;
+    const float* z_ = nullptr;
+    const float* n_x_ = nullptr;
+    const float* n_y_ = nullptr;
+    const float* n_z_ = nullptr;
+};
+
+//Structure-of-arrays point cloud: every coordinate and normal component lives in its own contiguous,
+//32-byte aligned array, so distance kernels over positions load only position data.
+class PointCloud {
+public:
+    static constexpr size_t Alignment = 32;
+    using Array = std::vector<float, AlignedAllocator<float, Alignment>>;
+
+    PointCloud() = default;
+
+    explicit PointCloud(const std::vector<GeneratedPoint>& points) {
+        resize(points.size());
+        for (size_t i = 0; i < points.size(); ++i)
+            Set(i, points[i]);
+    }
+
+    size_t size() const { return x_.size(); }
+    bool empty() const { return x_.empty(); }
+
+    void reserve(size_t count) {
+        for (auto* array : Arrays())
+            array->reserve(count);
+    }
+
+    void resize(size_t count) {
+        for (auto* array : Arrays())
+            array->resize(count);
+    }
+
+    void push_back(const GeneratedPoint& point) {
+        x_.push_back(point.x);
+        y_.push_back(point.y);
+        z_.push_back(point.z);
+        n_x_.push_back(point.n_x);
+        n_y_.push_back(point.n_y);
+        n_z_.push_back(point.n_z);
+    }
+
+    GeneratedPoint operator[](size_t index) const {
+        return { x_[index], y_[index], z_[index], n_x_[index], n_y_[index], n_z_[index] };
+    }
+
+    //Position only, the normal components keep their -1 default
+    GeneratedPoint Position(size_t index) const { return { x_[index], y_[index], z_[index] }; }
+
+    //Normal as a vector in the position components
+    GeneratedPoint Normal(size_t index) const { return { n_x_[index], n_y_[index], n_z_[index] }; }
+
+    void Set(size_t index, const GeneratedPoint& point) {
+        x_[index] = point.x;
+        y_[index] = point.y;
+        z_[index] = point.z;
+        n_x_[index] = point.n_x;
+        n_y_[index] = point.n_y;
+        n_z_[index] = point.n_z;
+    }
+
+    std::vector<GeneratedPoint> ToPoints() const { return PointCloudView(*this).ToPoints(); }
+
+    operator PointCloudView() const { return { size(), x(), y(), z(), n_x(), n_y(), n_z() }; }
+
+    const float* x() const { return x_.data(); }
+    const float* y() const { return y_.data(); }
+    const float* z() const { return z_.data(); }
+    const float* n_x() const { return n_x_.data(); }
+    const float* n_y() const { return n_y_.data(); }
+    const float* n_z() const { return n_z_.data(); }
+
+    float* x() { return x_.data(); }
+    float* y() { return y_.data(); }
+    float* z() { return z_.data(); }
+    float* n_x() { return n_x_.data(); }
+    float* n_y() { return n_y_.data(); }
+    float* n_z() { return n_z_.data(); }
+
+private:
+    std::array<Array*, 6> Arrays() { return { &x_, &y_, &z_, &n_x_, &n_y_, &n_z_ }; }
+
+    Array x_, y_, z_;
+    Array n_x_, n_y_, n_z_;
+};
+
+#endif // POINTCLOUD_H
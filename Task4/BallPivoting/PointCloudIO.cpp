@@ -0,0 +1,220 @@
+#include "PointCloudIO.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include "BinaryPointCloud.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+#include "Ply.h"
+
+namespace {
+
+//Files below this size per thread are parsed by fewer threads
+constexpr size_t MinChunkBytes = size_t{1} << 20;
+
+std::runtime_error MalformedLine(const std::string& fileName, size_t lineNumber) {
+    return std::runtime_error(fileName + ":" + std::to_string(lineNumber) + ": malformed point cloud line");
+}
+
+//Line-aligned slice [begin, end) of a text file. lines and points are counted by the first pass,
+//errorLine is the chunk relative number of the first malformed line or 0.
+struct TextChunk {
+    const char* begin;
+    const char* end;
+    size_t lines = 0;
+    size_t points = 0;
+    size_t errorLine = 0;
+};
+
+//Splits [data, data + size) into at most count chunks, each boundary moved past the next line break
+std::vector<TextChunk> SplitLines(const char* data, size_t size, size_t count) {
+    std::vector<TextChunk> chunks;
+    const char* end = data + size;
+    const char* begin = data;
+    for (size_t i = 1; i <= count && begin < end; ++i) {
+        const char* last = end;
+        if (i < count) {
+            last = std::max(begin, data + size / count * i);
+            const auto* newline = static_cast<const char*>(std::memchr(last, '\n', end - last));
+            last = newline ? newline + 1 : end;
+        }
+        chunks.push_back({begin, last});
+        begin = last;
+    }
+    return chunks;
+}
+
+//Calls body(lineBegin, lineEnd) for every line of the chunk without its line break until body returns false
+template <typename Body>
+void ForEachLine(const TextChunk& chunk, Body&& body) {
+    const char* line = chunk.begin;
+    while (line < chunk.end) {
+        const auto* newline = static_cast<const char*>(std::memchr(line, '\n', chunk.end - line));
+        const char* lineEnd = newline ? newline : chunk.end;
+        if (!body(line, lineEnd)) return;
+        line = newline ? newline + 1 : chunk.end;
+    }
+}
+
+//Parses three ';' terminated floats starting at begin, returns position after the last ';' or nullptr
+const char* ParseTriple(const char* begin, const char* end, std::array<float, 3>& values) {
+    for (auto& value : values) {
+        const auto [last, error] = std::from_chars(begin, end, value);
+        if (error != std::errc() || last == end || *last != ';') return nullptr;
+        begin = last + 1;
+    }
+    return begin;
+}
+
+bool ParsePoint(const char* begin, const char* end, GeneratedPoint& point) {
+    std::array<float, 3> position{}, normal{};
+    const char* rest = ParseTriple(begin, end, position);
+    if (!rest || rest == end || *rest != '/') return false;
+    rest = ParseTriple(rest + 1, end, normal);
+    if (rest != end) return false;
+
+    point = {position[0], position[1], position[2], normal[0], normal[1], normal[2]};
+    return true;
+}
+
+const char* TrimLineEnd(const char* begin, const char* end) {
+    return end != begin && end[-1] == '\r' ? end - 1 : end;
+}
+
+//Points formatted by one thread before the blocks of a round are written
+constexpr size_t WriteBlockPoints = size_t{1} << 16;
+
+//Longest float text of any precision to_chars is asked for, with room for the separator
+constexpr size_t MaxValueChars = 64;
+
+void AppendValue(std::string& buffer, float value, int precision, char separator) {
+    char text[MaxValueChars];
+    const auto result = precision > 0 ? std::to_chars(text, text + sizeof(text), value, std::chars_format::general, precision)
+                                      : std::to_chars(text, text + sizeof(text), value);
+    buffer.append(text, result.ptr);
+    buffer.push_back(separator);
+}
+
+//Appends the lines of points [begin, end) in the "x;y;z;/n_x;n_y;n_z;" layout
+void FormatPoints(std::string& buffer, const PointCloudView& points, size_t begin, size_t end, int precision) {
+    for (size_t i = begin; i < end; ++i) {
+        AppendValue(buffer, points.x()[i], precision, ';');
+        AppendValue(buffer, points.y()[i], precision, ';');
+        AppendValue(buffer, points.z()[i], precision, ';');
+        buffer.push_back('/');
+        AppendValue(buffer, points.n_x()[i], precision, ';');
+        AppendValue(buffer, points.n_y()[i], precision, ';');
+        AppendValue(buffer, points.n_z()[i], precision, ';');
+        buffer.push_back('\n');
+    }
+}
+
+void WriteTextPointCloud(const std::string& fileName, const PointCloudView& points, const PointCloudWriteOptions& options) {
+    std::ofstream out(fileName, std::ios::binary);
+    if (!out) throw std::runtime_error("cannot open " + fileName);
+
+    //Each round formats one block per thread into buffers reused by the next round, so memory stays bounded
+    const size_t threads = ResolveThreadCount(options.threads);
+    std::vector<std::string> buffers(threads);
+    for (size_t round = 0; round < points.size(); round += threads * WriteBlockPoints) {
+        const size_t blocks = std::min(threads, (points.size() - round + WriteBlockPoints - 1) / WriteBlockPoints);
+        ParallelForChunks(blocks, blocks, [&](size_t, size_t begin, size_t end) {
+            for (size_t b = begin; b < end; ++b) {
+                const size_t first = round + b * WriteBlockPoints;
+                buffers[b].clear();
+                FormatPoints(buffers[b], points, first, std::min(points.size(), first + WriteBlockPoints), options.precision);
+            }
+        });
+        for (size_t b = 0; b < blocks; ++b)
+            out.write(buffers[b].data(), static_cast<std::streamsize>(buffers[b].size()));
+    }
+
+    if (!out) throw std::runtime_error("failed writing " + fileName);
+}
+
+}
+
+PointCloud ReadPointCloud(const std::string& fileName, size_t threads) {
+    const MappedFile file(fileName);
+    threads = ResolveThreadCount(threads);
+    auto chunks = SplitLines(file.data(), file.size(), std::clamp<size_t>(file.size() / MinChunkBytes, 1, threads));
+
+    //Count first, so every chunk parses straight into its own range of the cloud
+    ParallelForChunks(chunks.size(), chunks.size(), [&](size_t, size_t begin, size_t end) {
+        for (auto c = begin; c < end; ++c) {
+            auto& chunk = chunks[c];
+            ForEachLine(chunk, [&](const char* line, const char* lineEnd) {
+                chunk.lines++;
+                if (TrimLineEnd(line, lineEnd) != line) chunk.points++;
+                return true;
+            });
+        }
+    });
+
+    std::vector<size_t> offsets(chunks.size() + 1, 0);
+    for (size_t c = 0; c < chunks.size(); ++c)
+        offsets[c + 1] = offsets[c] + chunks[c].points;
+
+    PointCloud points;
+    points.resize(offsets.back());
+    ParallelForChunks(chunks.size(), chunks.size(), [&](size_t, size_t begin, size_t end) {
+        for (auto c = begin; c < end; ++c) {
+            auto& chunk = chunks[c];
+            auto target = offsets[c];
+            size_t lineNumber = 0;
+            ForEachLine(chunk, [&](const char* line, const char* lineEnd) {
+                ++lineNumber;
+                lineEnd = TrimLineEnd(line, lineEnd);
+                if (lineEnd == line) return true;
+
+                GeneratedPoint point;
+                if (!ParsePoint(line, lineEnd, point)) {
+                    chunk.errorLine = lineNumber;
+                    return false;
+                }
+                points.Set(target++, point);
+                return true;
+            });
+        }
+    });
+
+    //Chunks before the first failing one were parsed to the end, so their line counts are complete
+    size_t linesBefore = 0;
+    for (const auto& chunk : chunks) {
+        if (chunk.errorLine != 0)
+            throw MalformedLine(fileName, linesBefore + chunk.errorLine);
+        linesBefore += chunk.lines;
+    }
+
+    return points;
+}
+
+PointCloudFormat PointCloudFormatFromFileName(const std::string& fileName) {
+    const auto dot = fileName.find_last_of('.');
+    std::string extension = dot == std::string::npos ? std::string() : fileName.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (extension == "txt") return PointCloudFormat::text;
+    if (extension == "bpc") return PointCloudFormat::binary;
+    if (extension == "ply") return PointCloudFormat::ply;
+    throw std::invalid_argument("unknown point cloud format of " + fileName + ", expected .txt, .bpc or .ply");
+}
+
+void WritePointCloud(const std::string& fileName, PointCloudFormat format, const PointCloudView& points,
+                     const PointCloudWriteOptions& options) {
+    switch (format) {
+    case PointCloudFormat::text:
+        WriteTextPointCloud(fileName, points, options);
+        break;
+    case PointCloudFormat::binary:
+        WriteBinaryPointCloud(fileName, points);
+        break;
+    case PointCloudFormat::ply:
+        WritePlyPointCloud(fileName, points);
+        break;
+    }
+}
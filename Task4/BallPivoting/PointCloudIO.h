@@ -0,0 +1,35 @@
+#ifndef POINTCLOUDIO_H
+#define POINTCLOUDIO_H
+
+#include <string>
+#include "DataStructures.h"
+#include "PointCloud.h"
+
+//Reads "x;y;z;/n_x;n_y;n_z;" lines, throws std::runtime_error with the line number on malformed input.
+//The file is memory mapped and split into line-aligned chunks parsed by up to threads threads, 0 uses every core.
+PointCloud ReadPointCloud(const std::string& fileName, size_t threads = 0);
+
+enum class PointCloudFormat {
+    text,
+    binary,
+    ply
+};
+
+//Format named by the extension: .txt, .bpc or .ply, throws std::invalid_argument for others
+PointCloudFormat PointCloudFormatFromFileName(const std::string& fileName);
+
+struct PointCloudWriteOptions {
+    //Significant digits of every text value, 0 writes the shortest text that reads back to the same float
+    int precision = 0;
+
+    //Threads formatting text, 0 uses every core
+    size_t threads = 0;
+};
+
+//Writes text in the layout ReadPointCloud reads, a .bpc file or a binary little endian PLY file.
+//Text is formatted block by block in parallel and written in order, the binary formats ignore the options.
+//Throws std::runtime_error when the file cannot be written.
+void WritePointCloud(const std::string& fileName, PointCloudFormat format, const PointCloudView& points,
+                     const PointCloudWriteOptions& options = {});
+
+#endif // POINTCLOUDIO_H
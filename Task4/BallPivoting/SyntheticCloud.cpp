@@ -0,0 +1,246 @@
+#include "SyntheticCloud.h"
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <stdexcept>
+#include <vector>
+#include "Parallel.h"
+
+namespace {
+
+constexpr double Pi = 3.14159265358979323846;
+
+//Segments of the table the ellipse perimeter is measured on
+constexpr size_t EllipseSegments = size_t{1} << 12;
+
+//SplitMix64 step
+uint64_t Mix(uint64_t value) {
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+//Random numbers of one point, seeded by the point index so the split into chunks cannot change them
+class PointRandom {
+public:
+    PointRandom(uint64_t seed, uint64_t index) : state_(Mix(seed ^ Mix(index))) { }
+
+    //Uniform in [0, 1)
+    float Uniform() {
+        state_ = Mix(state_);
+        return static_cast<float>(state_ >> 40) * 0x1.0p-24f;
+    }
+
+    //Standard normal by Box-Muller
+    float Gaussian() {
+        const float u = 1.0f - Uniform();
+        const float v = Uniform();
+        return std::sqrt(-2.0f * std::log(u)) * std::cos(2.0f * static_cast<float>(Pi) * v);
+    }
+
+private:
+    uint64_t state_;
+};
+
+//Point of a wall profile in the xy plane with its outward normal
+struct RingPoint {
+    float x, y;
+    float n_x, n_y;
+};
+
+void RequirePositive(std::initializer_list<float> sizes) {
+    for (const float size : sizes)
+        if (!(size > 0)) throw std::invalid_argument("synthetic shape sizes must be positive");
+}
+
+size_t Round(double value) {
+    return static_cast<size_t>(std::llround(value));
+}
+
+//Points around a profile of the given perimeter so walls of that height get about target points on a square grid
+size_t RingPointCount(size_t target, float perimeter, float height, size_t minimum) {
+    const size_t count = Round(std::sqrt(static_cast<double>(target) * perimeter / height));
+    return std::max(minimum, std::min(count, target));
+}
+
+std::vector<RingPoint> RectangleRing(float width, float depth, size_t count) {
+    const float perimeter = 2 * (width + depth);
+    const float x0 = -width / 2, y0 = -depth / 2;
+
+    //Counter-clockwise from the lower left corner: start, direction, length and outward normal of every side
+    struct Side {
+        float x, y, dx, dy, length, n_x, n_y;
+    };
+    const Side sides[] = {
+        {  x0,  y0,  1,  0, width,  0, -1 },
+        { -x0,  y0,  0,  1, depth,  1,  0 },
+        { -x0, -y0, -1,  0, width,  0,  1 },
+        {  x0, -y0,  0, -1, depth, -1,  0 }
+    };
+
+    std::vector<RingPoint> ring;
+    for (const auto& side : sides) {
+        const size_t points = std::max<size_t>(1, Round(static_cast<double>(count) * side.length / perimeter));
+        for (size_t j = 0; j < points; ++j) {
+            const float t = side.length * j / points;
+            ring.push_back({ side.x + side.dx * t, side.y + side.dy * t, side.n_x, side.n_y });
+        }
+    }
+    return ring;
+}
+
+//Arc length of the ellipse from angle 0 at every table entry, the last entry is the perimeter
+std::vector<double> EllipseArcLengths(float a, float b) {
+    std::vector<double> lengths(EllipseSegments + 1, 0.0);
+    double x = a, y = 0;
+    for (size_t k = 1; k <= EllipseSegments; ++k) {
+        const double t = 2 * Pi * k / EllipseSegments;
+        const double nx = a * std::cos(t), ny = b * std::sin(t);
+        lengths[k] = lengths[k - 1] + std::hypot(nx - x, ny - y);
+        x = nx;
+        y = ny;
+    }
+    return lengths;
+}
+
+//Points spaced evenly along the ellipse rather than evenly in angle, so flat and round parts get the same density
+std::vector<RingPoint> EllipseRing(float a, float b, const std::vector<double>& lengths, size_t count) {
+    std::vector<RingPoint> ring;
+    ring.reserve(count);
+    for (size_t k = 0; k < count; ++k) {
+        const double s = lengths.back() * k / count;
+        const size_t segment = std::min<size_t>(EllipseSegments - 1, std::upper_bound(lengths.begin(), lengths.end(), s) - lengths.begin() - 1);
+        const double fraction = (s - lengths[segment]) / (lengths[segment + 1] - lengths[segment]);
+        const double t = 2 * Pi * (segment + fraction) / EllipseSegments;
+        const double nx = b * std::cos(t), ny = a * std::sin(t);
+        const double length = std::hypot(nx, ny);
+        ring.push_back({ static_cast<float>(a * std::cos(t)), static_cast<float>(b * std::sin(t)),
+                         static_cast<float>(nx / length), static_cast<float>(ny / length) });
+    }
+    return ring;
+}
+
+GeneratedPoint RandomOutlier(PointRandom& random, const std::array<float, 3>& halfExtent) {
+    GeneratedPoint point((2 * random.Uniform() - 1) * halfExtent[0],
+                         (2 * random.Uniform() - 1) * halfExtent[1],
+                         (2 * random.Uniform() - 1) * halfExtent[2]);
+
+    const float nx = random.Gaussian(), ny = random.Gaussian(), nz = random.Gaussian();
+    const float length = std::sqrt(nx * nx + ny * ny + nz * nz);
+    if (length > 0) {
+        point.n_x = nx / length;
+        point.n_y = ny / length;
+        point.n_z = nz / length;
+    } else {
+        point.n_x = 0;
+        point.n_y = 0;
+        point.n_z = 1;
+    }
+    return point;
+}
+
+//Fills count surface points from sample(i), centered at the origin, then the outliers, in parallel.
+//Outliers fill the shape's bounding box, kept at least a tenth of its largest extent thick on every axis.
+template <typename Sample>
+PointCloud Generate(const SyntheticCloudOptions& options, size_t count, std::array<float, 3> halfExtent, Sample&& sample) {
+    const float largest = *std::max_element(halfExtent.begin(), halfExtent.end());
+    for (auto& extent : halfExtent)
+        extent = std::max(extent, largest / 10);
+
+    const size_t outliers = Round(static_cast<double>(count) * options.outliers);
+    PointCloud cloud;
+    cloud.resize(count + outliers);
+
+    ParallelForChunks(cloud.size(), ResolveThreadCount(options.threads), [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            PointRandom random(options.seed, i);
+            GeneratedPoint point = i < count ? sample(i) : RandomOutlier(random, halfExtent);
+            if (i < count && options.noise > 0) {
+                const float offset = options.noise * random.Gaussian();
+                point.x += point.n_x * offset;
+                point.y += point.n_y * offset;
+                point.z += point.n_z * offset;
+            }
+            point.x += options.center[0];
+            point.y += options.center[1];
+            point.z += options.center[2];
+            cloud.Set(i, point);
+        }
+    });
+    return cloud;
+}
+
+//Stacks the profile in evenly spaced layers from -height / 2 to height / 2
+PointCloud GenerateWalls(const SyntheticCloudOptions& options, const std::vector<RingPoint>& ring, float height,
+                         std::array<float, 3> halfExtent) {
+    const size_t layers = std::max<size_t>(1, Round(static_cast<double>(options.targetPoints) / ring.size()));
+    const float spacing = layers > 1 ? height / (layers - 1) : 0;
+    const float bottom = layers > 1 ? -height / 2 : 0;
+
+    return Generate(options, ring.size() * layers, halfExtent, [&](size_t i) {
+        const auto& point = ring[i % ring.size()];
+        return GeneratedPoint(point.x, point.y, bottom + spacing * (i / ring.size()), point.n_x, point.n_y, 0);
+    });
+}
+
+//Fibonacci lattice, every point covers about the same area
+PointCloud GenerateSphere(const SyntheticCloudOptions& options) {
+    const float radius = options.size[0];
+    const size_t count = options.targetPoints;
+    const double goldenAngle = Pi * (3 - std::sqrt(5.0));
+
+    return Generate(options, count, { radius, radius, radius }, [&](size_t i) {
+        const double z = 1 - (2 * static_cast<double>(i) + 1) / count;
+        const double r = std::sqrt(std::max(0.0, 1 - z * z));
+        const double phi = goldenAngle * i;
+        const auto nx = static_cast<float>(r * std::cos(phi)), ny = static_cast<float>(r * std::sin(phi)), nz = static_cast<float>(z);
+        return GeneratedPoint(radius * nx, radius * ny, radius * nz, nx, ny, nz);
+    });
+}
+
+//Cell centers of a grid over the rectangle, normals along +z
+PointCloud GeneratePlane(const SyntheticCloudOptions& options) {
+    const float width = options.size[0], depth = options.size[1];
+    const size_t columns = std::max<size_t>(1, Round(std::sqrt(static_cast<double>(options.targetPoints) * width / depth)));
+    const size_t rows = std::max<size_t>(1, Round(static_cast<double>(options.targetPoints) / columns));
+
+    return Generate(options, columns * rows, { width / 2, depth / 2, 0 }, [&](size_t i) {
+        const float x = width * ((i % columns) + 0.5f) / columns - width / 2;
+        const float y = depth * ((i / columns) + 0.5f) / rows - depth / 2;
+        return GeneratedPoint(x, y, 0, 0, 0, 1);
+    });
+}
+
+}
+
+PointCloud GenerateSyntheticCloud(const SyntheticCloudOptions& options) {
+    if (!(options.noise >= 0)) throw std::invalid_argument("synthetic noise must not be negative");
+    if (!(options.outliers >= 0)) throw std::invalid_argument("synthetic outlier fraction must not be negative");
+
+    const auto& size = options.size;
+    switch (options.shape) {
+    case SyntheticShape::parallelepiped: {
+        RequirePositive({ size[0], size[1], size[2] });
+        if (options.targetPoints == 0) return {};
+        const size_t ringPoints = RingPointCount(options.targetPoints, 2 * (size[0] + size[1]), size[2], 4);
+        return GenerateWalls(options, RectangleRing(size[0], size[1], ringPoints), size[2], { size[0] / 2, size[1] / 2, size[2] / 2 });
+    }
+    case SyntheticShape::ellipticCylinder: {
+        RequirePositive({ size[0], size[1], size[2] });
+        if (options.targetPoints == 0) return {};
+        const auto lengths = EllipseArcLengths(size[0], size[1]);
+        const size_t ringPoints = RingPointCount(options.targetPoints, static_cast<float>(lengths.back()), size[2], 3);
+        return GenerateWalls(options, EllipseRing(size[0], size[1], lengths, ringPoints), size[2], { size[0], size[1], size[2] / 2 });
+    }
+    case SyntheticShape::sphere:
+        RequirePositive({ size[0] });
+        if (options.targetPoints == 0) return {};
+        return GenerateSphere(options);
+    case SyntheticShape::plane:
+        RequirePositive({ size[0], size[1] });
+        if (options.targetPoints == 0) return {};
+        return GeneratePlane(options);
+    }
+    return {};
+}
@@ -0,0 +1,45 @@
+#ifndef SYNTHETICCLOUD_H
+#define SYNTHETICCLOUD_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "PointCloud.h"
+
+enum class SyntheticShape {
+    parallelepiped,
+    ellipticCylinder,
+    sphere,
+    plane
+};
+
+struct SyntheticCloudOptions {
+    SyntheticShape shape = SyntheticShape::sphere;
+
+    //Surface points to generate, the count comes as close as the rows and columns of the sampling allow
+    size_t targetPoints = 100'000;
+
+    //Parallelepiped: edge lengths along x, y and z. Elliptic cylinder: semi-axes along x and y and the height.
+    //Sphere: the radius in the first component. Plane: side lengths along x and y, the plane is z = 0.
+    std::array<float, 3> size = { 1.0f, 1.0f, 1.0f };
+    std::array<float, 3> center = { 0.0f, 0.0f, 0.0f };
+
+    //Standard deviation of a Gaussian offset of every surface point along its normal
+    float noise = 0.0f;
+
+    //Points spread uniformly over the bounding box with random normals, as a fraction of the surface points
+    float outliers = 0.0f;
+
+    //The same seed and options give the same cloud for any thread count
+    uint64_t seed = 1;
+
+    //Worker threads, 0 uses every core
+    size_t threads = 0;
+};
+
+//Samples the shape on a regular grid with unit normals pointing outwards, outliers follow the surface points.
+//Parallelepiped and elliptic cylinder are sampled on their side walls and stay open at both ends.
+//Throws std::invalid_argument for non-positive sizes of the shape, negative noise or a negative outlier fraction.
+PointCloud GenerateSyntheticCloud(const SyntheticCloudOptions& options);
+
+#endif // SYNTHETICCLOUD_H
@@ -0,0 +1,13 @@
+TEMPLATE = app
+TARGET = BallPivotingCli
+
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+SOURCES += \
+    main.cpp
+
+include(../BallPivoting/BallPivoting.pri)
+
+unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,195 @@
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "BallPivotingAlgorithm.h"
+#include "BinaryPointCloud.h"
+#include "MeshWriter.h"
+#include "Ply.h"
+#include "PointCloudIO.h"
+#include "SyntheticCloud.h"
+
+using namespace std;
+
+namespace {
+
+void PrintUsage(const char* program) {
+    cerr << "Usage: " << program << " [options] <input cloud .txt|.bpc|.ply> <radius[,radius...]> <output mesh .obj|.stl|.ply>\n"
+         << "       " << program << " --convert <input cloud .txt|.bpc|.ply> <output cloud .txt|.bpc|.ply>\n"
+         << "       " << program << " --generate <shape> <points> <output cloud .txt|.bpc|.ply>\n"
+         << "Several comma separated radii are pivoted in ascending order over one front.\n"
+         << "Binary .bpc clouds are memory mapped and read in place, .ply files are written as binary little endian.\n"
+         << "Options:\n"
+         << "  --threads <n>    worker threads, 0 uses every core (default)\n"
+         << "  --parallel       grow fronts in parallel grid slabs and stitch them\n"
+         << "  --front <order>  order of front edges: lifo (default), fifo or spatial\n"
+         << "  --morton         store the grid cells in Morton order\n"
+         << "Generator options, shapes are parallelepiped, cylinder (elliptic), sphere and plane:\n"
+         << "  --size <a,b,c>   edges of the parallelepiped, semi-axes and height of the cylinder,\n"
+         << "                   radius of the sphere or sides of the plane (default 1,1,1)\n"
+         << "  --noise <sigma>  Gaussian offset of the points along their normals\n"
+         << "  --outliers <f>   uniform outliers as a fraction of the surface points\n"
+         << "  --seed <n>       seed of the noise and the outliers (default 1)\n";
+}
+
+vector<float> ParseRadii(const string& argument) {
+    vector<float> radii;
+    stringstream in(argument);
+    string item;
+    while (getline(in, item, ','))
+        radii.push_back(stof(item));
+    if (radii.empty()) throw runtime_error("no radius given");
+    for (auto radius : radii)
+        if (!(radius > 0)) throw runtime_error("radius must be positive");
+    return radii;
+}
+
+//Text and PLY clouds are parsed into parsed, binary ones are mapped into mapped and used in place
+PointCloudView LoadCloud(const string& fileName, size_t threads, PointCloud& parsed, optional<MappedPointCloud>& mapped) {
+    if (IsBinaryPointCloud(fileName)) {
+        mapped.emplace(fileName);
+        return mapped->View();
+    }
+    parsed = IsPlyFile(fileName) ? ReadPlyPointCloud(fileName) : ReadPointCloud(fileName, threads);
+    return parsed;
+}
+
+array<float, 3> ParseSize(const string& argument) {
+    array<float, 3> size = { 1.0f, 1.0f, 1.0f };
+    stringstream in(argument);
+    string item;
+    for (size_t i = 0; i < size.size() && getline(in, item, ','); ++i)
+        size[i] = stof(item);
+    return size;
+}
+
+SyntheticShape ParseShape(const string& argument) {
+    if (argument == "parallelepiped") return SyntheticShape::parallelepiped;
+    if (argument == "cylinder") return SyntheticShape::ellipticCylinder;
+    if (argument == "sphere") return SyntheticShape::sphere;
+    if (argument == "plane") return SyntheticShape::plane;
+    throw runtime_error("unknown shape " + argument);
+}
+
+FrontOrder ParseFrontOrder(const string& argument) {
+    if (argument == "lifo") return FrontOrder::lifo;
+    if (argument == "fifo") return FrontOrder::fifo;
+    if (argument == "spatial") return FrontOrder::spatial;
+    throw runtime_error("unknown front order " + argument);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    try {
+        BallPivotingOptions options;
+        vector<string> positional;
+        bool convert = false;
+        bool generate = false;
+        SyntheticCloudOptions synthetic;
+        for (int i = 1; i < argc; ++i) {
+            const string argument = argv[i];
+            //Value of an option, which must not be the last argument
+            const auto value = [&]() -> const char* {
+                if (i + 1 >= argc) throw runtime_error("missing value for " + argument);
+                return argv[++i];
+            };
+            if (argument == "--threads") {
+                options.threads = stoul(value());
+            } else if (argument == "--parallel") {
+                options.parallelPivoting = true;
+            } else if (argument == "--front") {
+                options.frontOrder = ParseFrontOrder(value());
+            } else if (argument == "--morton") {
+                options.mortonOrder = true;
+            } else if (argument == "--convert") {
+                convert = true;
+            } else if (argument == "--generate") {
+                generate = true;
+            } else if (argument == "--size") {
+                synthetic.size = ParseSize(value());
+            } else if (argument == "--noise") {
+                synthetic.noise = stof(value());
+            } else if (argument == "--outliers") {
+                synthetic.outliers = stof(value());
+            } else if (argument == "--seed") {
+                synthetic.seed = stoull(value());
+            } else if (argument.rfind("--", 0) == 0) {
+                throw runtime_error("unknown option " + argument);
+            } else {
+                positional.push_back(argument);
+            }
+        }
+
+        PointCloudWriteOptions writeOptions;
+        writeOptions.threads = options.threads;
+
+        if (generate) {
+            if (positional.size() != 3) {
+                PrintUsage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            synthetic.shape = ParseShape(positional[0]);
+            synthetic.targetPoints = stoull(positional[1]);
+            synthetic.threads = options.threads;
+            const auto cloud = GenerateSyntheticCloud(synthetic);
+            WritePointCloud(positional[2], PointCloudFormatFromFileName(positional[2]), cloud, writeOptions);
+            cout << "points: " << cloud.size() << "\n";
+            return EXIT_SUCCESS;
+        }
+
+        if (convert) {
+            if (positional.size() != 2) {
+                PrintUsage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            PointCloud parsed;
+            optional<MappedPointCloud> mapped;
+            const auto cloud = LoadCloud(positional[0], options.threads, parsed, mapped);
+            WritePointCloud(positional[1], PointCloudFormatFromFileName(positional[1]), cloud, writeOptions);
+            return EXIT_SUCCESS;
+        }
+
+        if (positional.size() != 3) {
+            PrintUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        const string inputFile = positional[0];
+        const auto radii = ParseRadii(positional[1]);
+        const string outputFile = positional[2];
+
+        using Clock = chrono::steady_clock;
+        const auto loadStart = Clock::now();
+        PointCloud parsed;
+        optional<MappedPointCloud> mapped;
+        const PointCloudView points = LoadCloud(inputFile, options.threads, parsed, mapped);
+        const auto reconstructionStart = Clock::now();
+        //Triangles go to the file batch by batch while the reconstruction runs
+        MeshWriter writer(outputFile, MeshFormatFromFileName(outputFile), points);
+        DoBallPivotingAlgorithmStreamed(points, radii, options, [&](const IndexedTriangle* triangles, size_t count) {
+            writer.Write(triangles, count);
+        });
+        writer.Finish();
+        const auto end = Clock::now();
+        if (writer.TrianglesWritten() == 0)
+            cerr << "no seed triangle found, the mesh is empty\n";
+
+        const auto seconds = [](Clock::duration d) { return chrono::duration<double>(d).count(); };
+        cout << "points:                 " << points.size() << "\n"
+             << "triangles:              " << writer.TrianglesWritten() << "\n"
+             << "load, s:                " << seconds(reconstructionStart - loadStart) << "\n"
+             << "reconstruct + write, s: " << seconds(end - reconstructionStart) << "\n";
+    } catch (const exception& e) {
+        cerr << "error: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,10 @@
+TEMPLATE = app
+TARGET = BallPivotingTests
+
+CONFIG += console c++17 testcase
+CONFIG -= qt app_bundle
+
+SOURCES += \
+    main.cpp
+
+include(../BallPivoting/BallPivoting.pri)
@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "BallPivotingAlgorithm.h"
+#include "Grid.h"
+#include "MeshWriter.h"
+#include "Parallel.h"
+#include "Ply.h"
+#include "SyntheticCloud.h"
+
+using namespace std;
+
+namespace {
+
+int failures = 0;
+
+void Check(bool condition, const string& what) {
+    if (condition) return;
+    cerr << "FAILED: " << what << "\n";
+    ++failures;
+}
+
+//Faces using every undirected edge of the mesh
+map<pair<uint32_t, uint32_t>, size_t> EdgeUses(const vector<IndexedTriangle>& triangles) {
+    map<pair<uint32_t, uint32_t>, size_t> uses;
+    for (const auto& triangle : triangles)
+        for (size_t corner = 0; corner < 3; ++corner) {
+            const uint32_t a = triangle[corner], b = triangle[(corner + 1) % 3];
+            ++uses[{min(a, b), max(a, b)}];
+        }
+    return uses;
+}
+
+//A 200 x 200 grid with 0.002 spacing pivoted at r = 0.003 is covered by exactly two triangles per grid square.
+//The empty ball test must still reject points at such small radii, or triangles overlap. A little noise breaks
+//the ties between the four corners of a square, which lie on one circle on an exact grid.
+void PlaneAtSmallRadius() {
+    SyntheticCloudOptions options;
+    options.shape = SyntheticShape::plane;
+    options.targetPoints = 200 * 200;
+    options.size = { 0.4f, 0.4f, 1.0f };
+    options.noise = 1e-5f;
+    const auto cloud = GenerateSyntheticCloud(options);
+
+    const auto triangles = DoBallPivotingAlgorithmIndexed(PointCloudView(cloud), { 0.003f }, BallPivotingOptions{});
+    Check(triangles.size() == 2 * 199 * 199, "plane at a small radius: two triangles per grid square, got " + to_string(triangles.size()));
+
+    size_t boundary = 0;
+    bool manifold = true;
+    for (const auto& [edge, count] : EdgeUses(triangles)) {
+        manifold = manifold && count <= 2;
+        boundary += count == 1;
+    }
+    Check(manifold, "plane at a small radius: no edge shared by more than two triangles");
+    Check(boundary == 4 * 199, "plane at a small radius: only the border is open, got " + to_string(boundary) + " boundary edges");
+}
+
+//Morton order only moves whole cells around: every cell keeps its points in input order and the mesh is unchanged
+void MortonGridKeepsCells() {
+    SyntheticCloudOptions options;
+    options.shape = SyntheticShape::sphere;
+    options.targetPoints = 20'000;
+    options.noise = 1e-4f;
+    const auto cloud = GenerateSyntheticCloud(options);
+    const float radius = 0.05f;
+
+    const Grid linear(cloud, radius);
+    const Grid morton(cloud, radius, 0, true);
+    bool sameCells = true, reordered = false;
+    for (size_t c = 0; c < linear.CellCount(); ++c) {
+        const auto a = linear.GetCell(c), b = morton.GetCell(c);
+        sameCells = sameCells && a.size() == b.size();
+        reordered = reordered || a.first != b.first;
+        for (uint32_t i = 0; sameCells && i < a.size(); ++i)
+            sameCells = linear.points_[a.first + i].index == morton.points_[b.first + i].index;
+    }
+    Check(sameCells, "Morton grid: every cell holds the same points in the same order");
+    Check(reordered, "Morton grid: cells are stored in a different order");
+
+    BallPivotingOptions mortonOptions;
+    mortonOptions.mortonOrder = true;
+    const auto expected = DoBallPivotingAlgorithmIndexed(PointCloudView(cloud), { radius }, BallPivotingOptions{});
+    const auto triangles = DoBallPivotingAlgorithmIndexed(PointCloudView(cloud), { radius }, mortonOptions);
+    Check(!expected.empty() && triangles == expected, "Morton grid: the mesh matches the one of the linear grid");
+}
+
+//A radius far below the extent needs more cells than an int or the cell index holds, the grid refuses it
+void GridTooManyCells() {
+    const PointCloud cloud(vector<GeneratedPoint>{ { 0, 0, 0 }, { 1e30f, 1e30f, 1e30f } });
+    string error;
+    try {
+        const Grid grid(cloud, 1e-3f);
+    } catch (const runtime_error& e) {
+        error = e.what();
+    }
+    Check(error.find("too small") != string::npos, "grid with too many cells: got \"" + error + "\"");
+}
+
+//A chunk that throws does not terminate the program, the exception reaches the caller once every chunk finished
+void ParallelChunkException() {
+    vector<int> done(4, 0);
+    string error;
+    try {
+        ParallelForChunks(4, 4, [&](size_t chunk, size_t, size_t) {
+            if (chunk == 2) throw runtime_error("chunk 2 failed");
+            done[chunk] = 1;
+        });
+    } catch (const runtime_error& e) {
+        error = e.what();
+    }
+    Check(error == "chunk 2 failed", "parallel chunks: the exception of a worker reaches the caller, got \"" + error + "\"");
+    Check(done[0] && done[1] && done[3], "parallel chunks: the other chunks still run");
+}
+
+//A header announcing far more vertices than the file holds is reported as a PLY error, never allocated
+void PlyVertexCountBeyondFile() {
+    const string fileName = "ply_vertex_count_test.ply";
+    for (const string format : { "ascii", "binary_little_endian" }) {
+        {
+            ofstream out(fileName, ios::binary);
+            out << "ply\nformat " << format << " 1.0\nelement vertex 1000000000000\n"
+                << "property float x\nproperty float y\nproperty float z\nend_header\n";
+            if (format == "ascii") {
+                out << "0 0 0\n";
+            } else {
+                const float point[3] = { 0, 0, 0 };
+                out.write(reinterpret_cast<const char*>(point), sizeof(point));
+            }
+        }
+
+        string error;
+        try {
+            ReadPlyPointCloud(fileName);
+        } catch (const runtime_error& e) {
+            error = e.what();
+        } catch (const exception& e) {
+            error = string("unexpected ") + e.what();
+        }
+        Check(error.find("truncated") != string::npos, format + " PLY with a vertex count beyond the file: got \"" + error + "\"");
+    }
+    remove(fileName.c_str());
+}
+
+//A corrupt element count or list length is rejected instead of wrapping the number of bytes or values it skips
+void PlyCorruptCounts() {
+    const string fileName = "ply_corrupt_count_test.ply";
+    const auto readError = [&]() {
+        string error;
+        try {
+            ReadPlyPointCloud(fileName);
+        } catch (const runtime_error& e) {
+            error = e.what();
+        } catch (const exception& e) {
+            error = string("unexpected ") + e.what();
+        }
+        return error;
+    };
+
+    {
+        //2^61 records of 8 bytes wrap to a skip of none
+        ofstream out(fileName, ios::binary);
+        out << "ply\nformat binary_little_endian 1.0\nelement junk 2305843009213693952\nproperty double a\n"
+            << "element vertex 1\nproperty float x\nproperty float y\nproperty float z\nend_header\n";
+        const float point[3] = { 0, 0, 0 };
+        out.write(reinterpret_cast<const char*>(point), sizeof(point));
+    }
+    auto error = readError();
+    Check(error.find("truncated") != string::npos, "PLY element skip beyond the file: got \"" + error + "\"");
+
+    for (const string count : { "-1", "2.5", "1e30" }) {
+        {
+            ofstream out(fileName, ios::binary);
+            out << "ply\nformat ascii 1.0\nelement vertex 1\nproperty float x\nproperty float y\nproperty float z\n"
+                << "property list uchar int indices\nend_header\n0 0 0 " << count << " 7 7\n";
+        }
+        error = readError();
+        Check(error.find("malformed") != string::npos, "ascii PLY list length " + count + ": got \"" + error + "\"");
+    }
+    remove(fileName.c_str());
+}
+
+//A PLY target that cannot be opened fails Finish(), the spool is still removed with the writer
+void MeshWriterFailureRemovesSpool() {
+    namespace fs = std::filesystem;
+    const fs::path directory = "mesh_writer_test";
+    fs::remove_all(directory);
+    fs::create_directory(directory);
+    const auto target = directory / "mesh.ply";
+
+    const PointCloud vertices(vector<GeneratedPoint>{ { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 } });
+    bool failed = false;
+    {
+        MeshWriter writer(target.string(), MeshFormat::ply, vertices);
+        const IndexedTriangle triangle{ 0, 1, 2 };
+        writer.Write(&triangle, 1);
+        //A directory in place of the target makes opening it fail
+        fs::create_directory(target);
+        try {
+            writer.Finish();
+        } catch (const runtime_error&) {
+            failed = true;
+        }
+    }
+    Check(failed, "failed PLY write: Finish() throws");
+    Check(!fs::exists(target.string() + ".part"), "failed PLY write: the spool is removed");
+    fs::remove_all(directory);
+}
+
+}
+
+int main()
+{
+    const vector<pair<string, function<void()>>> tests = {
+        { "PlaneAtSmallRadius", PlaneAtSmallRadius },
+        { "MortonGridKeepsCells", MortonGridKeepsCells },
+        { "GridTooManyCells", GridTooManyCells },
+        { "ParallelChunkException", ParallelChunkException },
+        { "PlyVertexCountBeyondFile", PlyVertexCountBeyondFile },
+        { "PlyCorruptCounts", PlyCorruptCounts },
+        { "MeshWriterFailureRemovesSpool", MeshWriterFailureRemovesSpool }
+    };
+
+    for (const auto& [name, test] : tests) {
+        cout << name << "\n";
+        test();
+    }
+
+    if (failures != 0) {
+        cerr << failures << " check(s) failed\n";
+        return EXIT_FAILURE;
+    }
+    cout << "All tests passed\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,17 @@
+TEMPLATE = subdirs
+
+# Reconstruction library, its console front-end and its tests build without Qt GUI modules, "make check" runs the tests.
+# Run qmake with CONFIG+=headless to skip the QGLViewer based viewer (e.g. on build nodes without OpenGL).
+SUBDIRS += \
+    BallPivoting \
+    BallPivotingCli \
+    BallPivotingTests
+
+BallPivotingCli.depends = BallPivoting
+BallPivotingTests.depends = BallPivoting
+
+!headless {
+    SUBDIRS += Viewer
+    Viewer.file = newTask4.pro
+    Viewer.depends = BallPivoting
+}
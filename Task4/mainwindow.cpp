@@ -1,8 +1,13 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "BallPivotingAlgorithm.h"
-#include <array>
-#include <tuple>
+#include "BinaryPointCloud.h"
+#include "Ply.h"
+#include "PointCloudIO.h"
+#include "SyntheticCloud.h"
+#include <algorithm>
+#include <memory>
+#include <utility>
 
 using namespace std;
 
@@ -11,6 +16,14 @@ MainWindow::MainWindow(QWidget *parent)
     , ui(new Ui::MainWindow)
 {
     ui->setupUi(this);
+    ui->progressBar->hide();
+    ui->pushButton_2->hide();
+
+    Viewer* viewer = static_cast<Viewer*>(ui->openGLWidget);
+    connect(viewer, &Viewer::ReconstructionStarted, this, &MainWindow::OnReconstructionStarted);
+    connect(viewer, &Viewer::ReconstructionProgress, this, &MainWindow::OnReconstructionProgress);
+    connect(viewer, &Viewer::ReconstructionFinished, this, &MainWindow::OnReconstructionFinished);
+    viewer->SetBallRadius(ui->doubleSpinBox->value());
 }
 
 MainWindow::~MainWindow()
@@ -21,111 +34,74 @@ MainWindow::~MainWindow()
 //Open File
 void MainWindow::on_pushButton_clicked()
 {
-    QString textFilter = tr("Text Files (*.txt)");
+    QString textFilter = tr("Point Clouds (*.txt *.bpc *.ply)");
     QString fileName = QFileDialog::getOpenFileName(
                 this,
                 "Read Point Cloud Data",
                 QString(),
-                textFilter,
+                textFilter + ";;" + tr("Text Files (*.txt)") + ";;" + tr("Binary Point Clouds (*.bpc)") + ";;" + tr("PLY Files (*.ply)"),
                 &textFilter);
 
-    QFile inputFile(fileName);
-    inputFile.open(QIODevice::ReadOnly);
-    QTextStream in(&inputFile);
-
-    vector<GeneratedPoint> points;
-    while (!in.atEnd()){
-        QString line = in.readLine();
-        QStringList list = line.split("/", Qt::SkipEmptyParts);
-        QStringList pointList = list[0].split(";", Qt::SkipEmptyParts);
-        QStringList normalList = list[1].split(";", Qt::SkipEmptyParts);
-
-        points.push_back({pointList[0].toFloat(), pointList[1].toFloat(), pointList[2].toFloat(),
-                          normalList[0].toFloat(), normalList[1].toFloat(), normalList[2].toFloat()});
+    if (fileName.isEmpty()) return;
+
+    //Binary clouds stay mapped while the viewer shows them, the others are parsed into memory
+    shared_ptr<const MappedPointCloud> mapped;
+    PointCloud parsed;
+    try {
+        const auto localName = QFile::encodeName(fileName).toStdString();
+        if (IsBinaryPointCloud(localName))
+            mapped = make_shared<const MappedPointCloud>(localName);
+        else if (IsPlyFile(localName))
+            parsed = ReadPlyPointCloud(localName);
+        else
+            parsed = ReadPointCloud(localName);
+    } catch (const std::exception& e) {
+        QMessageBox::warning(this, "Read Point Cloud Data", QString::fromStdString(e.what()));
+        return;
+    }
+    if (mapped ? mapped->View().empty() : parsed.empty()) {
+        QMessageBox::warning(this, "Read Point Cloud Data", fileName + " holds no points");
+        return;
     }
 
-    inputFile.close();
-
-    static_cast<Viewer*>(ui->openGLWidget)->SetPointCloud(points);
+    Viewer* viewer = static_cast<Viewer*>(ui->openGLWidget);
+    if (mapped)
+        viewer->SetPointCloud(move(mapped));
+    else
+        viewer->SetPointCloud(move(parsed));
 }
 
 //Generate Parallelepiped Data
 void MainWindow::on_pushButton_3_clicked()
 {
-    const float squareSideIncrement = 0.002666667;
-    const size_t oneSidePointsCount = 149;
-    const float zMinValue = -1.0;
-    const float zMaxValue =  1.0;
-    const float zIncrement = 0.001 * 1.0000000161290;
-
-    const size_t POINTS_COUNT = 1'000'000;
-
-    vector<GeneratedPoint> points;
-    points.reserve(POINTS_COUNT);
-
-    std::array<tuple<float, float, float, float>, 4> startingPoints
-            = { tuple<float, float, float, float>{0.2, 0.6, squareSideIncrement, 0.0},
-                tuple<float, float, float, float>{0.6, 0.6, 0.0, -squareSideIncrement},
-                tuple<float, float, float, float>{0.6, 0.2, -squareSideIncrement, 0.0},
-                tuple<float, float, float, float>{0.2, 0.2, 0.0, squareSideIncrement} };
-
-    std::array<pair<float,float>, 4> normals
-            = { pair<float, float>{0.0, 1.0},
-                pair<float, float>{1.0, 0.0},
-                pair<float, float>{0.0, -1.0},
-                pair<float, float>{-1.0, 0.0} };
-
-    float currZ = zMinValue;
-    while (currZ <= zMaxValue){
-
-        for(size_t i = 0; i < startingPoints.size(); ++i){
-            float x = get<0>(startingPoints[i]);
-            float y = get<1>(startingPoints[i]);
-            float xIncrement = get<2>(startingPoints[i]);
-            float yIncrement = get<3>(startingPoints[i]);
-
-            for (size_t j = 0; j < oneSidePointsCount; ++j){
-                float n_x = normals[i].first;
-                float n_y = normals[i].second;
-                float n_z = 0;
-
-                float vectorLength = sqrt(n_x * n_x + n_y * n_y);
-                n_x /= vectorLength; n_y /= vectorLength;
-
-
-                points.push_back({
-                                     x,
-                                     y,
-                                     currZ,
-                                     n_x,
-                                     n_y,
-                                     n_z
-                                 });
-
-                x += xIncrement;
-                y += yIncrement;
-            }
-        }
-        currZ += zIncrement;
-    }
-
-    QString textFilter = tr("Text Files (*.txt)");
+    //Side walls of a 0.4 x 0.4 x 2 box around (0.4, 0.4, 0), about as dense as the viewer's sample cloud
+    SyntheticCloudOptions options;
+    options.shape = SyntheticShape::parallelepiped;
+    options.targetPoints = 1'200'000;
+    options.size = { 0.4f, 0.4f, 2.0f };
+    options.center = { 0.4f, 0.4f, 0.0f };
+    const PointCloud points = GenerateSyntheticCloud(options);
+
+    QString cloudFilter = tr("Text Files (*.txt)");
     QString fileName = QFileDialog::getSaveFileName(
                 this,
-                "Save Ellipse Like Cylinder Data",
+                "Save Synthetic Parallelepiped Cloud",
                 QString(),
-                textFilter,
-                &textFilter);
-
-    QFile outputFile(fileName);
-    outputFile.open(QIODevice::WriteOnly);
-    QTextStream out(&outputFile);
-
-    for (auto& point : points){
-        out << point.x << ";" << point.y << ";" << point.z << ";/" << point.n_x << ";" << point.n_y << ";" << point.n_z << ";\n";
+                cloudFilter + ";;" + tr("Binary Point Clouds (*.bpc)") + ";;" + tr("Binary PLY (*.ply)"),
+                &cloudFilter);
+
+    if (fileName.isEmpty()) return;
+    //Names typed without an extension take the one of the selected filter
+    if (QFileInfo(fileName).suffix().isEmpty())
+        fileName += cloudFilter.mid(cloudFilter.indexOf("*.") + 1, 4);
+
+    try {
+        const string name = QFile::encodeName(fileName).toStdString();
+        WritePointCloud(name, PointCloudFormatFromFileName(name), points);
+        ui->statusbar->showMessage("Point cloud saved to " + fileName);
+    } catch (const std::exception& e) {
+        QMessageBox::warning(this, "Save Synthetic Parallelepiped Cloud", QString::fromStdString(e.what()));
     }
-
-    outputFile.close();
 }
 
 //Scale
@@ -172,3 +148,79 @@ void MainWindow::on_checkBox_3_stateChanged(int state)
     }
 }
 
+//Radius
+void MainWindow::on_doubleSpinBox_valueChanged(double radius)
+{
+    Viewer* viewer = static_cast<Viewer*>(ui->openGLWidget);
+    viewer->SetBallRadius(static_cast<float>(radius));
+}
+
+//Abort Reconstruction
+void MainWindow::on_pushButton_2_clicked()
+{
+    Viewer* viewer = static_cast<Viewer*>(ui->openGLWidget);
+    viewer->CancelReconstruction();
+    ui->statusbar->showMessage("Aborting reconstruction...");
+}
+
+//Save Mesh
+void MainWindow::on_pushButton_4_clicked()
+{
+    Viewer* viewer = static_cast<Viewer*>(ui->openGLWidget);
+    if (!viewer->HasSurface()){
+        QMessageBox::information(this, "Save Mesh", "Reconstruct the surface first");
+        return;
+    }
+
+    QString meshFilter = tr("Wavefront OBJ (*.obj)");
+    QString fileName = QFileDialog::getSaveFileName(
+                this,
+                "Save Mesh",
+                QString(),
+                meshFilter + ";;" + tr("Binary STL (*.stl)") + ";;" + tr("Binary PLY (*.ply)"),
+                &meshFilter);
+
+    if (fileName.isEmpty()) return;
+    //Names typed without an extension take the one of the selected filter
+    if (QFileInfo(fileName).suffix().isEmpty())
+        fileName += meshFilter.mid(meshFilter.indexOf("*.") + 1, 4);
+
+    try {
+        viewer->SaveSurface(QFile::encodeName(fileName).toStdString());
+        ui->statusbar->showMessage("Mesh saved to " + fileName);
+    } catch (const std::exception& e) {
+        QMessageBox::warning(this, "Save Mesh", QString::fromStdString(e.what()));
+    }
+}
+
+void MainWindow::OnReconstructionStarted()
+{
+    ui->progressBar->setRange(0, 0);
+    ui->progressBar->show();
+    ui->pushButton_2->show();
+    ui->statusbar->showMessage("Searching seed triangle...");
+}
+
+void MainWindow::OnReconstructionProgress(const BallPivotingProgress& progress)
+{
+    //QProgressBar is int based, report per mille of consumed points
+    ui->progressBar->setRange(0, 1000);
+    ui->progressBar->setValue(static_cast<int>(1000 * progress.pointsUsed / max<size_t>(progress.pointsTotal, 1)));
+    ui->statusbar->showMessage(QString("Points: %1 / %2, front: %3, triangles: %4")
+                               .arg(progress.pointsUsed)
+                               .arg(progress.pointsTotal)
+                               .arg(progress.frontSize)
+                               .arg(progress.trianglesEmitted));
+}
+
+void MainWindow::OnReconstructionFinished(bool completed, size_t triangles)
+{
+    ui->progressBar->hide();
+    ui->pushButton_2->hide();
+    if (completed && triangles == 0)
+        ui->statusbar->showMessage("Reconstruction finished, no seed triangle found", 5000);
+    else if (completed)
+        ui->statusbar->showMessage(QString("Reconstruction finished, %1 triangles").arg(triangles), 5000);
+    else
+        ui->statusbar->showMessage("Reconstruction aborted", 5000);
+}
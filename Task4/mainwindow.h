@@ -6,6 +6,8 @@
 #include <cmath>
 #include <QFileDialog>
 #include <QFile>
+#include <QFileInfo>
+#include <QMessageBox>
 #include <QTextStream>
 #include "BallPivotingAlgorithm.h"
 
@@ -35,6 +37,18 @@ private slots:
 
     void on_checkBox_3_stateChanged(int arg1);
 
+    void on_doubleSpinBox_valueChanged(double arg1);
+
+    void on_pushButton_2_clicked();
+
+    void on_pushButton_4_clicked();
+
+    void OnReconstructionStarted();
+
+    void OnReconstructionProgress(const BallPivotingProgress& progress);
+
+    void OnReconstructionFinished(bool completed, size_t triangles);
+
 private:
     Ui::MainWindow *ui;
 };
@@ -1,7 +1,7 @@
 QT       += opengl
 QT       += core gui
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets xml openglwidgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets xml openglwidgets concurrent
 
 CONFIG += c++17
 
@@ -10,20 +10,19 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
-    BallPivotingAlgorithm.cpp \
     main.cpp \
     mainwindow.cpp \
     simpleViewer.cpp
 
 HEADERS += \
-    BallPivotingAlgorithm.h \
-    DataStructures.h \
     mainwindow.h \
     simpleViewer.h
 
 FORMS += \
     mainwindow.ui
 
+include(BallPivoting/BallPivoting.pri)
+
 
 INCLUDEPATH *= E:\QtProjects\libQGLViewer-2.8.0\libQGLViewer-2.8.0
 LIBS *= -LE:\QtProjects\libQGLViewer-2.8.0\libQGLViewer-2.8.0\QGLViewer -lQGLViewer2
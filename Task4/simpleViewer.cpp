@@ -1,44 +1,73 @@
 #include "simpleViewer.h"
+#include "Grid.h"
+#include "MeshWriter.h"
+#include "Parallel.h"
+#include <QtConcurrent/QtConcurrent>
+#include <limits>
+#include <utility>
 
 using namespace std;
 
 Viewer::Viewer(QWidget* parent) :
     QGLViewer(parent), draw_scale_(false),
     draw_grid_(false), draw_surface_(false),
-    draw_normals_(false) {}
+    draw_normals_(false), surface_valid_(false),
+    ball_radius_(0.01f), reconstruction_id_(0),
+    positions_buffer_(QOpenGLBuffer::VertexBuffer), colors_buffer_(QOpenGLBuffer::VertexBuffer),
+    indices_buffer_(QOpenGLBuffer::IndexBuffer), use_buffers_(false),
+    points_dirty_(false), points_buffered_(false), surface_buffered_(false),
+    buffered_triangles_(0), index_capacity_(0)
+{
+    connect(&reconstruction_, &QFutureWatcher<void>::finished, this, &Viewer::OnReconstructionFinished);
+}
+
+Viewer::~Viewer()
+{
+    cancellation_.Cancel();
+    reconstruction_.waitForFinished();
+
+    //Buffers are freed in the context they were created in
+    makeCurrent();
+    positions_buffer_.destroy();
+    colors_buffer_.destroy();
+    indices_buffer_.destroy();
+    doneCurrent();
+}
 
 
-void Viewer::SetPointCloud(const std::vector<GeneratedPoint> &pointCloud)
+void Viewer::SetPointCloud(PointCloud pointCloud)
 {
-    float currMin_x = pointCloud[0].x, currMax_x = currMin_x;
-    float currMin_y = pointCloud[0].y, currMax_y = currMin_y;
-    float currMin_z = pointCloud[0].z, currMax_z = currMin_z;
+    auto owner = make_shared<const PointCloud>(move(pointCloud));
+    const PointCloudView view = *owner;
+    const CloudBounds bounds = view.empty() ? CloudBounds{} : ComputeBounds(view, ResolveThreadCount(0));
+    SetPointCloudView(move(owner), view, bounds);
+}
 
-    for (auto& point : pointCloud){
-        {
-            if (point.x < currMin_x) currMin_x = point.x;
-            if (point.x > currMax_x) currMax_x = point.x;
-        }
-        {
-            if (point.y < currMin_y) currMin_y = point.y;
-            if (point.y > currMax_y) currMax_y = point.y;
-        }
-        {
-            if (point.z < currMin_z) currMin_z = point.z;
-            if (point.z > currMax_z) currMax_z = point.z;
-        }
-    }
-    point_cloud_.resize(pointCloud.size());
-    copy(begin(pointCloud), end(pointCloud), begin(point_cloud_));
+void Viewer::SetPointCloud(std::shared_ptr<const MappedPointCloud> pointCloud)
+{
+    const PointCloudView view = pointCloud->View();
+    const CloudBounds bounds = pointCloud->Bounds();
+    SetPointCloudView(move(pointCloud), view, bounds);
+}
+
+void Viewer::SetPointCloudView(std::shared_ptr<const void> owner, const PointCloudView& view, const CloudBounds& bounds)
+{
+    //The old cloud may still be read by a reconstruction, which is stopped before it is released
+    InvalidateSurface();
+    cloud_owner_ = move(owner);
+    point_cloud_ = view;
 
-    min_x_ = currMin_x;
-    max_x_ = currMax_x;
+    min_x_ = bounds.lower.x;
+    max_x_ = bounds.upper.x;
 
-    min_y_ = currMin_y;
-    max_y_ = currMax_y;
+    min_y_ = bounds.lower.y;
+    max_y_ = bounds.upper.y;
 
-    min_z_ = currMin_z;
-    max_z_ = currMax_z;
+    min_z_ = bounds.lower.z;
+    max_z_ = bounds.upper.z;
+
+    points_dirty_ = true;
+    UpdateSurface();
 
     this->setFocus();
 }
@@ -64,9 +93,109 @@ void Viewer::SetDrawNormals(bool drawNormals)
 void Viewer::SetDrawSurface(bool drawSurface)
 {
     draw_surface_ = drawSurface;
+    UpdateSurface();
     this->setFocus();
 }
 
+void Viewer::SetBallRadius(float ballRadius)
+{
+    if (ballRadius != ball_radius_){
+        ball_radius_ = ballRadius;
+        InvalidateSurface();
+        UpdateSurface();
+    }
+    this->setFocus();
+}
+
+void Viewer::CancelReconstruction()
+{
+    cancellation_.Cancel();
+}
+
+bool Viewer::HasSurface() const
+{
+    return surface_valid_;
+}
+
+void Viewer::SaveSurface(const std::string& fileName) const
+{
+    MeshWriter writer(fileName, MeshFormatFromFileName(fileName), point_cloud_);
+    writer.Write(surface_.data(), surface_.size());
+    writer.Finish();
+}
+
+void Viewer::InvalidateSurface()
+{
+    if (reconstruction_.isRunning()){
+        cancellation_.Cancel();
+        reconstruction_.waitForFinished();
+    }
+    //Batches still queued for the old run are ignored
+    ++reconstruction_id_;
+    ClearSurface();
+    surface_valid_ = false;
+}
+
+void Viewer::ClearSurface()
+{
+    surface_.clear();
+    //The buffer holds a prefix of surface_, which now starts over
+    buffered_triangles_ = 0;
+}
+
+void Viewer::UpdateSurface()
+{
+    if (!draw_surface_ || surface_valid_ || reconstruction_.isRunning() || point_cloud_.empty())
+        return;
+
+    const unsigned id = ++reconstruction_id_;
+    BallPivotingOptions options;
+    options.progress = [this, id](const BallPivotingProgress& progress){
+        QMetaObject::invokeMethod(this, [this, id, progress]{
+            if (id == reconstruction_id_)
+                emit ReconstructionProgress(progress);
+        }, Qt::QueuedConnection);
+    };
+    //Smaller batches than the default so the surface visibly grows while the ball rolls
+    options.triangleBatch = 16384;
+    cancellation_ = options.cancellation;
+
+    ClearSurface();
+    reconstruction_.setFuture(QtConcurrent::run([this, id, owner = cloud_owner_, points = point_cloud_, radius = ball_radius_, options]() {
+        DoBallPivotingAlgorithmStreamed(points, {radius}, options, [this, id](const IndexedTriangle* triangles, size_t count){
+            QMetaObject::invokeMethod(this, [this, id, batch = vector<IndexedTriangle>(triangles, triangles + count)]{
+                OnTrianglesReceived(id, batch);
+            }, Qt::QueuedConnection);
+        });
+    }));
+    emit ReconstructionStarted();
+}
+
+void Viewer::OnTrianglesReceived(unsigned id, const std::vector<IndexedTriangle>& triangles)
+{
+    //Batches of a run that was replaced since are dropped
+    if (id != reconstruction_id_ || surface_valid_)
+        return;
+    surface_.insert(surface_.end(), triangles.begin(), triangles.end());
+    update();
+}
+
+void Viewer::OnReconstructionFinished()
+{
+    if (!reconstruction_.isFinished())
+        return;
+
+    //Every batch was posted before the run finished, so all of them have been received by now
+    const bool completed = !cancellation_.IsCancelled();
+    if (!completed){
+        ClearSurface();
+    } else {
+        surface_valid_ = true;
+    }
+    emit ReconstructionFinished(completed, surface_.size());
+    update();
+}
+
 void Viewer::DrawScale(){
     const int viewerWidth  = this->width();
     const int viewerHeight = this->height();
@@ -280,70 +409,141 @@ void Viewer::DrawNormals()
 {
     glColor3f(1.0, 1.0, 1.0);
     glBegin(GL_LINES);
-    for (auto& point : point_cloud_){
+    for (size_t i = 0; i < point_cloud_.size(); ++i){
+        const GeneratedPoint point = point_cloud_[i];
         glVertex3f(point.x, point.y, point.z);
         glVertex3f(point.n_x + point.x, point.n_y + point.y, point.n_z + point.z);
     }
     glEnd();
 }
 
-void Viewer::draw() {
+void Viewer::UploadBuffers()
+{
+    const auto fits = [](size_t bytes) { return bytes <= static_cast<size_t>(numeric_limits<int>::max()); };
+    //A buffer the driver could not allocate is drawn from in immediate mode instead.
+    //Errors left by earlier calls are dropped first so only the allocation is checked.
+    const auto allocated = [](auto&& allocate) {
+        while (glGetError() != GL_NO_ERROR) { }
+        allocate();
+        return glGetError() != GL_OUT_OF_MEMORY;
+    };
+
+    if (points_dirty_){
+        points_dirty_ = false;
+        points_buffered_ = fits(point_cloud_.size() * 3 * sizeof(float));
+        if (points_buffered_){
+            //Fixed function vertex arrays take interleaved xyz, the cloud keeps every coordinate in its own array
+            vector<float> positions;
+            vector<GeneratedColor> colors;
+            positions.reserve(point_cloud_.size() * 3);
+            colors.reserve(point_cloud_.size());
+            for (size_t i = 0; i < point_cloud_.size(); ++i){
+                positions.insert(positions.end(), { point_cloud_.x()[i], point_cloud_.y()[i], point_cloud_.z()[i] });
+                colors.push_back(GetColorByZ(point_cloud_.z()[i]));
+            }
 
-    if (draw_surface_){
-
-        //HardCoded Parallelepiped Surface Drawing
-        vector<GeneratedPoint> lowerPlane = { {0.2, 0.2, -0.99}, {0.2, 0.6, -0.99}, {0.6, 0.6, -0.99}, {0.6, 0.2, -0.99} };
-        vector<GeneratedPoint> lowerMiddlePlane = { {0.2, 0.2, -0.5}, {0.2, 0.6, -0.5}, {0.6, 0.6, -0.5}, {0.6, 0.2, -0.5} };
-        vector<GeneratedPoint> middlePlane = { {0.2, 0.2, 0.0}, {0.2, 0.6, 0.0}, {0.6, 0.6, 0.0}, {0.6, 0.2, 0.0} };
-        vector<GeneratedPoint> upperMiddlePlane = { {0.2, 0.2, 0.5}, {0.2, 0.6, 0.5}, {0.6, 0.6, 0.5}, {0.6, 0.2, 0.5} };
-        vector<GeneratedPoint> upperPlane = { {0.2, 0.2, 0.99}, {0.2, 0.6, 0.99}, {0.6, 0.6, 0.99}, {0.6, 0.2, 0.99} };
-        vector<GeneratedPoint> inputPoints;
-
-        array<vector<GeneratedPoint>, 5> planes = { lowerPlane, lowerMiddlePlane, middlePlane, upperMiddlePlane, upperPlane};
-
-        for (size_t i = 0; i < planes.size() - 1; ++i){
-            inputPoints.clear();
-
-            auto& low = planes[i];
-            auto& up = planes[i + 1];
-            for_each(begin(low), end(low), [](GeneratedPoint& point)->void{
-                point.n_x = 0.0;
-                point.n_y = 0.0;
-                point.n_z = -1.0;
-            });
-
-            for_each(begin(up), end(up), [](GeneratedPoint& point)->void{
-                point.n_x = 0.0;
-                point.n_y = 0.0;
-                point.n_z = 1.0;
-            });
-
-            copy(begin(low), end(low), back_inserter(inputPoints));
-            copy(begin(up), end(up), back_inserter(inputPoints));
-
-            cout << "Starting algorithm" << endl;
-            auto triangles = DoBallPivotingAlgorithm(inputPoints, 0.6);
-            cout << "Ending algorithm" << endl;
-
-            glBegin(GL_TRIANGLES);
-            for (auto& triangle : triangles){
-                for (int i = 0; i < 3; ++i){
-                    GeneratedColor color = GetColorByZ(triangle[i].z);
-                    glColor3f(color.r, color.g, color.b);
-                    glVertex3f(triangle[i].x, triangle[i].y, triangle[i].z);
-                }
+            positions_buffer_.bind();
+            points_buffered_ = allocated([&]{ positions_buffer_.allocate(positions.data(), static_cast<int>(positions.size() * sizeof(float))); });
+            colors_buffer_.bind();
+            points_buffered_ = points_buffered_ &&
+                allocated([&]{ colors_buffer_.allocate(colors.data(), static_cast<int>(colors.size() * sizeof(GeneratedColor))); });
+            colors_buffer_.release();
+        }
+    }
+
+    //Only the triangles that arrived since the last frame are written, the buffer doubles when they do not fit
+    if (buffered_triangles_ < surface_.size()){
+        surface_buffered_ = points_buffered_ && fits(surface_.size() * 2 * sizeof(IndexedTriangle));
+        if (!surface_buffered_)
+            return;
+
+        indices_buffer_.bind();
+        if (surface_.size() > index_capacity_){
+            index_capacity_ = surface_.size() * 2;
+            buffered_triangles_ = 0;
+            surface_buffered_ = allocated([&]{ indices_buffer_.allocate(static_cast<int>(index_capacity_ * sizeof(IndexedTriangle))); });
+            if (!surface_buffered_){
+                index_capacity_ = 0;
+                indices_buffer_.release();
+                return;
             }
-            glEnd();
         }
+        indices_buffer_.write(static_cast<int>(buffered_triangles_ * sizeof(IndexedTriangle)), surface_.data() + buffered_triangles_,
+                              static_cast<int>((surface_.size() - buffered_triangles_) * sizeof(IndexedTriangle)));
+        indices_buffer_.release();
+        buffered_triangles_ = surface_.size();
+    }
+}
 
-    } else {
-        glBegin(GL_POINTS);
-        for (auto& point : point_cloud_){
+void Viewer::BindPointArrays()
+{
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    positions_buffer_.bind();
+    glVertexPointer(3, GL_FLOAT, 3 * sizeof(float), nullptr);
+    colors_buffer_.bind();
+    glColorPointer(3, GL_FLOAT, sizeof(GeneratedColor), nullptr);
+    colors_buffer_.release();
+}
+
+void Viewer::UnbindPointArrays()
+{
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void Viewer::DrawPoints()
+{
+    if (use_buffers_ && points_buffered_){
+        BindPointArrays();
+        glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(point_cloud_.size()));
+        UnbindPointArrays();
+        return;
+    }
+
+    glBegin(GL_POINTS);
+    for (size_t i = 0; i < point_cloud_.size(); ++i){
+        const GeneratedPoint point = point_cloud_.Position(i);
+        GeneratedColor color = GetColorByZ(point.z);
+        glColor3f(color.r, color.g, color.b);
+        glVertex3f(point.x, point.y, point.z);
+    }
+    glEnd();
+}
+
+void Viewer::DrawSurface()
+{
+    if (use_buffers_ && surface_buffered_ && buffered_triangles_ == surface_.size()){
+        BindPointArrays();
+        indices_buffer_.bind();
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(buffered_triangles_ * 3), GL_UNSIGNED_INT, nullptr);
+        indices_buffer_.release();
+        UnbindPointArrays();
+        return;
+    }
+
+    glBegin(GL_TRIANGLES);
+    for (auto& triangle : surface_){
+        for (int i = 0; i < 3; ++i){
+            const GeneratedPoint point = point_cloud_.Position(triangle[i]);
             GeneratedColor color = GetColorByZ(point.z);
             glColor3f(color.r, color.g, color.b);
             glVertex3f(point.x, point.y, point.z);
         }
-        glEnd();
+    }
+    glEnd();
+}
+
+void Viewer::draw() {
+
+    if (use_buffers_){
+        UploadBuffers();
+    }
+
+    if (draw_surface_ && !surface_.empty()){
+        DrawSurface();
+    } else {
+        DrawPoints();
     }
 
     if (draw_grid_){
@@ -361,6 +561,8 @@ void Viewer::draw() {
 
 void Viewer::init() {
     restoreStateFromFile();
+    //The context is current from here on, without buffer objects every frame is drawn in immediate mode
+    use_buffers_ = positions_buffer_.create() && colors_buffer_.create() && indices_buffer_.create();
     //help();
 }
 
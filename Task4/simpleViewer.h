@@ -2,28 +2,59 @@
 #define SIMPLEVIEWER_H
 
 #include <QGLViewer/qglviewer.h>
+#include <QFutureWatcher>
+#include <QOpenGLBuffer>
+#include <memory>
 #include <vector>
 #include <algorithm>
 #include "BallPivotingAlgorithm.h"
+#include "BinaryPointCloud.h"
 
 class Viewer : public QGLViewer {
+    Q_OBJECT
 public:
     Viewer(QWidget* parent);
-    void SetPointCloud(const std::vector<GeneratedPoint>& pointCloud);
+    ~Viewer();
+    //The viewer owns the cloud from here on. A mapped cloud is drawn and reconstructed from the file pages, never copied.
+    void SetPointCloud(PointCloud pointCloud);
+    void SetPointCloud(std::shared_ptr<const MappedPointCloud> pointCloud);
     void SetDrawScale(bool drawScale);
     void SetDrawGrid(bool drawGrid);
     void SetDrawNormals(bool drawNormals);
     void SetDrawSurface(bool drawSurface);
+    void SetBallRadius(float ballRadius);
+    void CancelReconstruction();
+    bool HasSurface() const;
+    //Writes the reconstructed surface in the format named by the extension, throws for other extensions and write errors
+    void SaveSurface(const std::string& fileName) const;
+signals:
+    void ReconstructionStarted();
+    void ReconstructionProgress(const BallPivotingProgress& progress);
+    //Triangles of the finished surface, 0 when the reconstruction was cancelled
+    void ReconstructionFinished(bool completed, size_t triangles);
 protected:
   virtual void draw();
   virtual void init();
   virtual QString helpString() const;
 private:
+    void SetPointCloudView(std::shared_ptr<const void> owner, const PointCloudView& view, const CloudBounds& bounds);
     void DrawScale();
     void DrawGrid();
     void DrawNormals();
+    void DrawPoints();
+    void DrawSurface();
+    void UploadBuffers();
+    void BindPointArrays();
+    void UnbindPointArrays();
+    void ClearSurface();
+    void UpdateSurface();
+    void InvalidateSurface();
+    void OnTrianglesReceived(unsigned id, const std::vector<IndexedTriangle>& triangles);
+    void OnReconstructionFinished();
     GeneratedColor GetColorByZ(float z);
-    std::vector<GeneratedPoint> point_cloud_;
+    //Keeps the storage behind point_cloud_ alive, shared with a running reconstruction
+    std::shared_ptr<const void> cloud_owner_;
+    PointCloudView point_cloud_;
 
     float min_x_;
     float min_y_;
@@ -37,6 +68,29 @@ private:
     bool draw_grid_;
     bool draw_surface_;
     bool draw_normals_;
+
+    //Triangles indexing point_cloud_, streamed in from a worker thread and reset when the cloud or the radius changes.
+    //Valid once the whole reconstruction arrived, the part received so far is drawn while it runs.
+    std::vector<IndexedTriangle> surface_;
+    bool surface_valid_;
+    float ball_radius_;
+
+    QFutureWatcher<void> reconstruction_;
+    CancellationToken cancellation_;
+    unsigned reconstruction_id_;
+
+    //Points, their colors and the surface indices in vertex buffers, drawn with a few calls per frame.
+    //Filled on the first frame after the cloud changes, triangles streamed in are appended to the index buffer.
+    //Immediate mode draws whatever the buffers cannot hold or the driver fails to allocate, or everything where they cannot be created.
+    QOpenGLBuffer positions_buffer_;
+    QOpenGLBuffer colors_buffer_;
+    QOpenGLBuffer indices_buffer_;
+    bool use_buffers_;
+    bool points_dirty_;
+    bool points_buffered_;
+    bool surface_buffered_;
+    size_t buffered_triangles_;
+    size_t index_capacity_;
 };
 
 #endif // SIMPLEVIEWER_H